@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+#include <Util/FileSystem.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Tree
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Tree of 5 levels with 6 directories and 16 empty files in each directory (about 25k entries)
+ */
+static auto tree() -> const std::string &
+{
+	static const auto root = [] {
+		const auto root = std::filesystem::temp_directory_path() / "utl_walk_bench";
+		std::filesystem::remove_all(root);
+
+		auto fill = [](auto &self, const std::filesystem::path &dir, size_t level) -> void {
+			std::filesystem::create_directories(dir);
+			for (size_t i = 0; i < 16; ++i) std::ofstream(dir / ("file" + std::to_string(i)));
+			if (level < 5)
+				for (size_t i = 0; i < 6; ++i) self(self, dir / ("dir" + std::to_string(i)), level + 1);
+		};
+		fill(fill, root, 1);
+
+		return root.string();
+	}();
+
+	return root;
+}
+
+/**
+ * @brief 4096 files of 16 KiB
+ */
+static auto files() -> const std::vector<std::string> &
+{
+	static const auto paths = [] {
+		const auto root = std::filesystem::temp_directory_path() / "utl_read_bench";
+		std::filesystem::create_directories(root);
+
+		std::vector<std::string> res;
+		for (size_t i = 0; i < 4096; ++i)
+		{
+			res.emplace_back((root / ("file" + std::to_string(i))).string());
+			std::ofstream(res.back()) << std::string(16 << 10, char('a' + i % 26));
+		}
+		return res;
+	}();
+
+	return paths;
+}
+
+// -----------------------------------------------------------------------------
+// Walking
+// -----------------------------------------------------------------------------
+
+static void BM_Recursive_Directory_Iterator(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		size_t n = 0;
+		for (const auto &e : std::filesystem::recursive_directory_iterator(tree())) n += e.is_regular_file();
+		benchmark::DoNotOptimize(n);
+	}
+}
+BENCHMARK(BM_Recursive_Directory_Iterator)->UseRealTime();
+
+static void BM_Walk_Directory(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		std::atomic<size_t> n = 0;
+		utl::walk_directory(tree(), { .threads = size_t(state.range(0)) },
+							[&n](const utl::DirEntry &e) { n.fetch_add(e.type == utl::EntryType::FILE, std::memory_order_relaxed); });
+		benchmark::DoNotOptimize(n.load());
+	}
+}
+BENCHMARK(BM_Walk_Directory)->Arg(1)->Arg(4)->UseRealTime();
+
+static void BM_Walk_Directory_Stat(benchmark::State &state)
+{
+	for (auto _ : state)
+	{
+		std::atomic<size_t> n = 0;
+		utl::walk_directory(tree(), { .threads = size_t(state.range(0)), .stat_mask = STATX_SIZE },
+							[&n](const utl::DirEntry &e) { n.fetch_add(e.stat->stx_size, std::memory_order_relaxed); });
+		benchmark::DoNotOptimize(n.load());
+	}
+}
+BENCHMARK(BM_Walk_Directory_Stat)->Arg(1)->Arg(4)->UseRealTime();
+
+// -----------------------------------------------------------------------------
+// Reading
+// -----------------------------------------------------------------------------
+
+static void BM_Read_Files(benchmark::State &state)
+{
+	utl::FileReader reader({ .queue_depth = unsigned(state.range(1)), .threads = 4, .io_uring = state.range(0) != 0 });
+	if (reader.uses_io_uring() != (state.range(0) != 0))
+		return state.SkipWithError("io_uring isn't available");
+
+	for (auto _ : state)
+	{
+		std::atomic<size_t> bytes = 0;
+		reader.read(files(), [&bytes](const utl::FileRead &f) { bytes.fetch_add(f.data.size(), std::memory_order_relaxed); });
+		benchmark::DoNotOptimize(bytes.load());
+	}
+
+	state.SetBytesProcessed(int64_t(state.iterations() * files().size() * (16 << 10)));
+}
+BENCHMARK(BM_Read_Files)->ArgNames({ "io_uring", "depth" })->Args({ 0, 0 })->Args({ 1, 16 })->Args({ 1, 64 })->UseRealTime();
@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+#include <Util/EdgeList.h>
+#include <Util/Graph.h>
+#include <Util/Routes.h>
+
+#include <random>
+
+// -----------------------------------------------------------------------------
+// Graphs
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Random graph of 100k nodes with 8 weighed edges each
+ */
+static auto random_graph() -> const utl::CSRGraph<utl::WeighedEdge> &
+{
+	static const auto csr = [] {
+		constexpr size_t NODES = 100'000, DEGREE = 8;
+
+		std::mt19937					 gen(7);
+		utl::CSRGraph<utl::WeighedEdge> res;
+		for (size_t n = 0; n < NODES; ++n)
+		{
+			res.idx.emplace_back(res.edges.size());
+			for (size_t i = 0; i < DEGREE; ++i) res.edges.push_back({ gen() % NODES, uint32_t(gen() % 100 + 1) });
+		}
+		res.idx.emplace_back(res.edges.size());
+
+		return res;
+	}();
+
+	return csr;
+}
+
+// -----------------------------------------------------------------------------
+// Searches
+// -----------------------------------------------------------------------------
+
+static void BM_Dijkstra(benchmark::State &state)
+{
+	const auto g = random_graph().graph();
+
+	size_t start = 0;
+	for (auto _ : state)
+	{
+		auto res = utl::dijkstra_search(g, start++ % g.size, [](size_t, uint32_t w) { return w > 20; });
+		benchmark::DoNotOptimize(res.second.data());
+	}
+}
+BENCHMARK(BM_Dijkstra);
+
+static void BM_Dijkstra_Arena(benchmark::State &state)
+{
+	const auto g	 = random_graph().graph();
+	auto	  &arena = utl::ArenaResource::local();
+
+	size_t start = 0;
+	for (auto _ : state)
+	{
+		{
+			auto res = utl::dijkstra_search(
+				g, start++ % g.size, [](size_t, uint32_t w) { return w > 20; }, &arena);
+			benchmark::DoNotOptimize(res.second.data());
+		}
+		arena.reset();
+	}
+}
+BENCHMARK(BM_Dijkstra_Arena);
+
+static void BM_Breadth_First_Search(benchmark::State &state)
+{
+	const auto g = random_graph().graph();
+
+	size_t start = 0;
+	for (auto _ : state)
+	{
+		auto res = utl::breadth_first_search(g, start++ % g.size);
+		benchmark::DoNotOptimize(res.data());
+	}
+}
+BENCHMARK(BM_Breadth_First_Search);
+
+static void BM_Breadth_First_Search_Arena(benchmark::State &state)
+{
+	const auto g	 = random_graph().graph();
+	auto	  &arena = utl::ArenaResource::local();
+
+	size_t start = 0;
+	for (auto _ : state)
+	{
+		{
+			auto res = utl::breadth_first_search(
+				g, start++ % g.size, [](size_t) { return false; }, &arena);
+			benchmark::DoNotOptimize(res.data());
+		}
+		arena.reset();
+	}
+}
+BENCHMARK(BM_Breadth_First_Search_Arena);
+
+// -----------------------------------------------------------------------------
+// Distance tables
+// -----------------------------------------------------------------------------
+
+static auto table_nodes(size_t n, uint32_t seed) -> std::vector<size_t>
+{
+	std::mt19937		gen(seed);
+	std::vector<size_t> res(n);
+	for (auto &v : res) v = gen() % (random_graph().idx.size() - 1);
+	return res;
+}
+
+static void BM_Distance_Table(benchmark::State &state)
+{
+	const auto g	   = random_graph().graph();
+	const auto sources = table_nodes(size_t(state.range(0)), 1);
+	const auto targets = table_nodes(size_t(state.range(0)), 2);
+
+	for (auto _ : state)
+	{
+		auto res = utl::distance_table(g, sources, targets);
+		benchmark::DoNotOptimize(res.data.data());
+	}
+}
+BENCHMARK(BM_Distance_Table)->Arg(64)->Unit(benchmark::kMillisecond);
+
+static void BM_Distance_Table_Dijkstra(benchmark::State &state)
+{
+	const auto g	   = random_graph().graph();
+	const auto sources = table_nodes(size_t(state.range(0)), 1);
+	const auto targets = table_nodes(size_t(state.range(0)), 2);
+
+	for (auto _ : state)
+	{
+		std::vector<uint32_t> res;
+		for (const auto s : sources)
+		{
+			const auto route = utl::dijkstra_search(g, s);
+			for (const auto t : targets) res.push_back(route.second[t]);
+		}
+		benchmark::DoNotOptimize(res.data());
+	}
+}
+BENCHMARK(BM_Distance_Table_Dijkstra)->Arg(64)->Unit(benchmark::kMillisecond);
+
+// -----------------------------------------------------------------------------
+// Routes
+// -----------------------------------------------------------------------------
+
+static void BM_K_Shortest_Paths(benchmark::State &state)
+{
+	const auto		 g = random_graph().graph();
+	utl::RouteEngine engine(g);
+
+	size_t start = 1;
+	for (auto _ : state)
+	{
+		auto res = engine.k_shortest_paths(start++ % g.size, 0, size_t(state.range(0)));
+		benchmark::DoNotOptimize(res.data());
+	}
+}
+BENCHMARK(BM_K_Shortest_Paths)->Arg(1)->Arg(4);
+
+static void BM_Alternative_Routes(benchmark::State &state)
+{
+	const auto		 g = random_graph().graph();
+	utl::RouteEngine engine(g);
+
+	size_t start = 1;
+	for (auto _ : state)
+	{
+		auto res = engine.alternative_routes(start++ % g.size, 0, size_t(state.range(0)));
+		benchmark::DoNotOptimize(res.data());
+	}
+}
+BENCHMARK(BM_Alternative_Routes)->Arg(1)->Arg(4);
\ No newline at end of file
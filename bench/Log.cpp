@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include <Util/BinaryLog.h>
+#include <Util/Error.h>
+#include <Util/Profile.h>
+
+#include <filesystem>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Policy discarding everything, so only the producer side is measured
+ */
+class NullPolicy
+{
+public:
+	void open() noexcept {}
+	void close() noexcept {}
+
+	template<typename T>
+	void write(const T &, utl::Catagory) noexcept
+	{
+	}
+};
+
+static auto temp_path(std::string_view name) -> std::string
+{
+	return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// -----------------------------------------------------------------------------
+// Producer Cost
+// -----------------------------------------------------------------------------
+
+static void BM_Logger_Stream(benchmark::State &state)
+{
+	utl::Logger<NullPolicy> log;
+
+	size_t i = 0;
+	for (auto _ : state) log.write(utl::Catagory::INFO) << "request " << ++i << " took " << 0.25 << " ms";
+}
+BENCHMARK(BM_Logger_Stream);
+
+static void BM_AsyncLogger(benchmark::State &state)
+{
+	utl::AsyncLogger<NullPolicy> log(1 << 16, utl::AsyncLogger<NullPolicy>::BLOCK, NullPolicy());
+
+	size_t i = 0;
+	for (auto _ : state) log.write(utl::Catagory::INFO) << "request " << ++i << " took " << 0.25 << " ms";
+}
+BENCHMARK(BM_AsyncLogger)->UseRealTime();
+
+static void BM_BinaryLogger(benchmark::State &state)
+{
+	utl::BinaryLogger log(temp_path("utl_bench.blog"), 1 << 22);
+
+	size_t i = 0;
+	for (auto _ : state) UTL_BLOG(log, utl::Catagory::INFO, "request {} took {} ms", ++i, 0.25);
+}
+BENCHMARK(BM_BinaryLogger)->UseRealTime();
+
+// -----------------------------------------------------------------------------
+// Timestamps
+// -----------------------------------------------------------------------------
+
+static void BM_Timestamp(benchmark::State &state)
+{
+	utl::TimestampFormatter f;
+	for (auto _ : state) benchmark::DoNotOptimize(f.format(std::chrono::system_clock::now()));
+}
+BENCHMARK(BM_Timestamp);
+
+static void BM_Timestamp_Strftime(benchmark::State &state)
+{
+	char buf[32];
+	for (auto _ : state)
+	{
+		const auto t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+		tm		   time;
+		gmtime_r(&t, &time);
+		benchmark::DoNotOptimize(std::strftime(buf, sizeof buf, "%Y-%m-%d %H:%M:%S ", &time));
+	}
+}
+BENCHMARK(BM_Timestamp_Strftime);
+
+// -----------------------------------------------------------------------------
+// Profile
+// -----------------------------------------------------------------------------
+
+static void BM_Profile_Scope(benchmark::State &state)
+{
+	static utl::ProfileSite site("bench");
+	for (auto _ : state) utl::ProfileScope scope(site);
+}
+BENCHMARK(BM_Profile_Scope);
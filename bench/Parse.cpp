@@ -0,0 +1,288 @@
+#include <benchmark/benchmark.h>
+#include <Util/Commandline.h>
+#include <Util/Parse.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Corpora
+// -----------------------------------------------------------------------------
+
+static constexpr size_t CORPUS_SIZE = 1 << 22;
+
+static constexpr std::array<std::string_view, 8> keywords = { "GET",  "HEAD",	 "POST",  "PUT",
+															  "PATCH", "DELETE", "TRACE", "OPTIONS" };
+
+/**
+ * @brief Short words separated by long runs of mixed whitespace
+ */
+static auto whitespace_heavy() -> const std::string &
+{
+	static const auto res = [] {
+		std::mt19937 gen(1);
+		std::string	 s;
+		while (s.size() < CORPUS_SIZE)
+		{
+			s.append(1 + gen() % 4, 'a' + gen() % 26);
+			for (auto n = 8 + gen() % 32; n != 0; --n) s += " \t\n"[gen() % 3];
+		}
+		return s;
+	}();
+	return res;
+}
+
+/**
+ * @brief Tokens of hundreds of characters separated by single spaces
+ */
+static auto long_tokens() -> const std::string &
+{
+	static const auto res = [] {
+		std::mt19937 gen(2);
+		std::string	 s;
+		while (s.size() < CORPUS_SIZE)
+		{
+			for (auto n = 64 + gen() % 512; n != 0; --n) s += char('!' + gen() % 94);
+			s += ' ';
+		}
+		return s;
+	}();
+	return res;
+}
+
+/**
+ * @brief Lines of 8 comma separated integers
+ */
+static auto numeric_csv() -> const std::string &
+{
+	static const auto res = [] {
+		std::mt19937 gen(3);
+		std::string	 s;
+		while (s.size() < CORPUS_SIZE)
+		{
+			for (size_t i = 0; i < 8; ++i)
+			{
+				s += std::to_string(gen() >> (gen() % 32));
+				s += i == 7 ? '\n' : ',';
+			}
+		}
+		return s;
+	}();
+	return res;
+}
+
+/**
+ * @brief Request lines of a text protocol: "METHOD /path\n"
+ */
+static auto keyword_dense() -> const std::string &
+{
+	static const auto res = [] {
+		std::mt19937 gen(4);
+		std::string	 s;
+		while (s.size() < CORPUS_SIZE)
+		{
+			s += keywords[gen() % keywords.size()];
+			s += " /";
+			s.append(1 + gen() % 16, 'a' + gen() % 26);
+			s += '\n';
+		}
+		return s;
+	}();
+	return res;
+}
+
+/**
+ * @brief Report the throughput and the time per token
+ */
+static void report(benchmark::State &state, size_t bytes, size_t tokens)
+{
+	state.SetBytesProcessed(int64_t(state.iterations() * bytes));
+	state.counters["ns_per_token"] = benchmark::Counter(double(state.iterations() * tokens) / 1e9,
+														benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// -----------------------------------------------------------------------------
+// SequentialParser
+// -----------------------------------------------------------------------------
+
+static void BM_Skip_Space(benchmark::State &state)
+{
+	const auto &text   = whitespace_heavy();
+	size_t		tokens = 0;
+
+	for (auto _ : state)
+	{
+		utl::SequentialParser p(text);
+		for (tokens = 0; !p.at_end(); ++tokens)
+		{
+			p.skip_space();
+			benchmark::DoNotOptimize(p.take());
+		}
+	}
+
+	report(state, text.size(), tokens);
+}
+BENCHMARK(BM_Skip_Space);
+
+static void BM_Take(benchmark::State &state)
+{
+	const auto &text   = long_tokens();
+	size_t		tokens = 0;
+
+	for (auto _ : state)
+	{
+		utl::SequentialParser p(text);
+		for (tokens = 0; !p.at_end(); ++tokens)
+		{
+			benchmark::DoNotOptimize(p.take());
+			p.skip_space();
+		}
+	}
+
+	report(state, text.size(), tokens);
+}
+BENCHMARK(BM_Take);
+
+static void BM_Get_Until(benchmark::State &state)
+{
+	const auto &text   = numeric_csv();
+	size_t		tokens = 0;
+
+	for (auto _ : state)
+	{
+		utl::SequentialParser p(text);
+		for (tokens = 0; !p.at_end(); ++tokens)
+		{
+			benchmark::DoNotOptimize(p.get_until(utl::CharSet(",\n")));
+			p.skip_for(1);
+		}
+	}
+
+	report(state, text.size(), tokens);
+}
+BENCHMARK(BM_Get_Until);
+
+static void BM_Get_Integer(benchmark::State &state)
+{
+	const auto &text   = numeric_csv();
+	size_t		tokens = 0;
+
+	for (auto _ : state)
+	{
+		utl::SequentialParser p(text);
+		for (tokens = 0; !p.at_end(); ++tokens)
+		{
+			benchmark::DoNotOptimize(p.get<uint32_t>());
+			p.skip_for(1);
+		}
+	}
+
+	report(state, text.size(), tokens);
+}
+BENCHMARK(BM_Get_Integer);
+
+static void BM_Get_One_Of_Linear(benchmark::State &state)
+{
+	const auto &text   = keyword_dense();
+	size_t		tokens = 0;
+
+	for (auto _ : state)
+	{
+		utl::SequentialParser p(text);
+		for (tokens = 0; !p.at_end(); ++tokens)
+		{
+			benchmark::DoNotOptimize(p.get_one_of(keywords.begin(), keywords.end()));
+			p.skip_till('\n');
+		}
+	}
+
+	report(state, text.size(), tokens);
+}
+BENCHMARK(BM_Get_One_Of_Linear);
+
+static void BM_Get_One_Of_Matcher(benchmark::State &state)
+{
+	constexpr utl::KeywordMatcher<keywords> matcher;
+
+	const auto &text   = keyword_dense();
+	size_t		tokens = 0;
+
+	for (auto _ : state)
+	{
+		utl::SequentialParser p(text);
+		for (tokens = 0; !p.at_end(); ++tokens)
+		{
+			benchmark::DoNotOptimize(p.get_one_of(matcher));
+			p.skip_till('\n');
+		}
+	}
+
+	report(state, text.size(), tokens);
+}
+BENCHMARK(BM_Get_One_Of_Matcher);
+
+// -----------------------------------------------------------------------------
+// Commandline
+// -----------------------------------------------------------------------------
+
+static void BM_Arg_To_Data(benchmark::State &state)
+{
+	const std::vector<const char *> argv = { "./exec", "-vvx",	   "input.txt", "--output", "out.txt",
+											 "-j8",	   "--format", "json",		"-q",		"other.txt" };
+
+	size_t bytes = 0;
+	for (const auto *a : argv) bytes += std::strlen(a);
+
+	uint32_t	v = 0, x = 0, q = 0;
+	std::string in, other, out, format, jobs;
+
+	for (auto _ : state)
+	{
+		v = x = q = 0;
+		utl::arg_to_data(int(argv.size()), argv.data(),
+						 utl::Arguments<2, 2, 1, 3>{ .optional_names		= { "output", "format" },
+													 .optional_short_names	= { 'j' },
+													 .flag_names			= { 'v', 'x', 'q' },
+													 .required_values		= { &in, &other },
+													 .optional_values		= { &out, &format },
+													 .optional_short_values = { &jobs },
+													 .flag_values			= { &v, &x, &q } });
+		benchmark::DoNotOptimize(in.data());
+	}
+
+	report(state, bytes, argv.size() - 1);
+}
+BENCHMARK(BM_Arg_To_Data);
+
+static constexpr utl::ArgNames<2, 2, 1, 3> bench_args { .optional_names		= { "output", "format" },
+														.optional_short_names	= { 'j' },
+														.flag_names			= { 'v', 'x', 'q' } };
+
+static void BM_Bind_Args(benchmark::State &state)
+{
+	const std::vector<const char *> argv = { "./exec", "-vvx",	   "input.txt", "--output", "out.txt",
+											 "-j8",	   "--format", "json",		"-q",		"other.txt" };
+
+	size_t bytes = 0;
+	for (const auto *a : argv) bytes += std::strlen(a);
+
+	uint32_t		 v = 0, x = 0, q = 0, jobs = 0;
+	std::string_view in, other, out, format;
+
+	for (auto _ : state)
+	{
+		v = x = q = 0;
+		utl::bind_args<bench_args>(int(argv.size()), argv.data(),
+								   { .required_values		= { in, other },
+									 .optional_values		= { out, format },
+									 .optional_short_values = { jobs },
+									 .flag_values			= { &v, &x, &q } });
+		benchmark::DoNotOptimize(in.data());
+	}
+
+	report(state, bytes, argv.size() - 1);
+}
+BENCHMARK(BM_Bind_Args);
@@ -0,0 +1,641 @@
+#if not defined _UTILLIB_BINARYLOG_
+#define _UTILLIB_BINARYLOG_
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Error.h"
+
+#if defined unix || defined __unix || defined __unix__
+
+/**
+ * @brief Log to a BinaryLogger. The format and its argument types are stored once per call site, a call only copies the
+ * raw arguments and a timestamp. "{}" in the format is replaced by the arguments when decoding.
+ *
+ * @param logger BinaryLogger to write to
+ * @param catagory Catagory of the record
+ * @param format String literal with a "{}" for each argument
+ */
+#define UTL_BLOG(logger, catagory, format, ...)                                                                     \
+	do                                                                                                              \
+	{                                                                                                               \
+		static constexpr ::utl::LogSite _utl_site_ {                                                                \
+			catagory, format, __FILE__, __LINE__,                                                                   \
+			::utl::detail::_arg_types_of_<decltype(::utl::detail::_type_list_(__VA_ARGS__))>                         \
+		};                                                                                                          \
+		static_assert(::utl::detail::_placeholders_(format) == _utl_site_.types.size(),                            \
+					  "Placeholder count doesn't match the arguments.");                                           \
+		if constexpr ((catagory) >= ::utl::LOG_MIN_SEVERITY)                                                       \
+			(logger).log(_utl_site_ __VA_OPT__(, ) __VA_ARGS__);                                                    \
+	} while (false)
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Call Sites
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Argument types of a binary log
+	 */
+	enum BinaryArg : uint8_t
+	{
+		INT,
+		UINT,
+		FLOAT,
+		BOOL,
+		CHAR,
+		STRING,
+	};
+
+	/**
+	 * @brief Static information of a log call
+	 */
+	struct LogSite
+	{
+		Catagory				  catagory;
+		std::string_view		  format;
+		std::string_view		  file;
+		uint32_t				  line;
+		std::span<const uint8_t> types;
+	};
+
+	namespace detail
+	{
+		template<typename... T>
+		struct _TypeList_
+		{
+		};
+
+		template<typename... T>
+		auto _type_list_(const T &...) -> _TypeList_<std::decay_t<T>...>;
+
+		template<typename T>
+		consteval auto _arg_type_() -> uint8_t
+		{
+			if constexpr (std::is_same_v<T, bool>)
+				return BOOL;
+			else if constexpr (std::is_same_v<T, char>)
+				return CHAR;
+			else if constexpr (std::is_enum_v<T>)
+				return _arg_type_<std::underlying_type_t<T>>();
+			else if constexpr (std::is_integral_v<T>)
+				return std::is_signed_v<T> ? INT : UINT;
+			else if constexpr (std::is_floating_point_v<T>)
+				return FLOAT;
+			else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+				return STRING;
+			else
+				static_assert(!sizeof(T), "Type can't be logged in binary.");
+		}
+
+		template<typename T>
+		constexpr std::array<uint8_t, 0> _arg_types_of_;
+
+		template<typename... T>
+		constexpr std::array<uint8_t, sizeof...(T)> _arg_types_of_<_TypeList_<T...>> = { _arg_type_<T>()... };
+
+		consteval auto _placeholders_(std::string_view fmt) -> size_t
+		{
+			size_t n = 0;
+			for (auto i = fmt.find("{}"); i != std::string_view::npos; i = fmt.find("{}", i + 2)) ++n;
+			return n;
+		}
+
+		inline void _put_varint_(std::string &out, uint64_t v)
+		{
+			for (; v >= 0x80; v >>= 7) out += char(v | 0x80);
+			out += char(v);
+		}
+
+		inline auto _get_varint_(const char *&p, const char *end) -> uint64_t
+		{
+			uint64_t v = 0;
+			for (unsigned shift = 0; p != end && shift < 64; shift += 7)
+			{
+				const auto b = uint8_t(*p++);
+				v |= uint64_t(b & 0x7F) << shift;
+				if ((b & 0x80) == 0)
+					return v;
+			}
+
+			throw std::runtime_error("Malformed binary log.");
+		}
+
+		constexpr auto _zigzag_(int64_t v) noexcept -> uint64_t { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+		constexpr auto _unzigzag_(uint64_t v) noexcept -> int64_t { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+		inline auto _next_logger_id_() noexcept -> uint64_t
+		{
+			static std::atomic<uint64_t> id = 0;
+			return ++id;
+		}
+
+		/**
+		 * @brief Single producer single consumer byte ring holding the raw records of one thread. Records are 8 byte
+		 * aligned and never wrap, the rest of the ring is skipped with a padding record instead.
+		 */
+		class _Staging_
+		{
+		public:
+			static constexpr size_t	  HEADER = 24;					 // Size, site, timestamp
+			static constexpr uint64_t PAD	 = uint64_t(1) << 63; // Size flag of padding records
+
+			explicit _Staging_(size_t capacity)
+				: m_buf(std::make_unique<uint64_t[]>(capacity / 8))
+				, m_mask(capacity - 1)
+			{
+			}
+
+			/**
+			 * @brief Reserve space for a record, waiting for the consumer while full
+			 */
+			auto reserve(size_t size) noexcept -> char *
+			{
+				auto	   pos	= m_head.load(std::memory_order_relaxed);
+				const auto left = m_mask + 1 - (pos & m_mask);
+				const auto need = size + (left < size ? left : 0);
+
+				while (pos + need - m_tail.load(std::memory_order_acquire) > m_mask + 1) std::this_thread::yield();
+
+				if (left < size) // Skip the end of the ring
+				{
+					*_at_(pos) = left | PAD;
+					m_head.store(pos += left, std::memory_order_release);
+				}
+
+				return reinterpret_cast<char *>(_at_(pos));
+			}
+
+			void commit(size_t size) noexcept
+			{
+				m_head.store(m_head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+			}
+
+			/**
+			 * @brief Consume the available records
+			 * @param f Callback taking the record begin
+			 */
+			template<typename F>
+			void drain(F &&f)
+			{
+				const auto head = m_head.load(std::memory_order_acquire);
+				auto	   tail = m_tail.load(std::memory_order_relaxed);
+
+				for (; tail != head;)
+				{
+					const auto *rec = _at_(tail);
+					if ((*rec & PAD) == 0)
+						f(reinterpret_cast<const char *>(rec));
+					tail += *rec & ~PAD;
+				}
+
+				m_tail.store(tail, std::memory_order_release);
+			}
+
+			[[nodiscard]] auto capacity() const noexcept -> size_t { return m_mask + 1; }
+
+			/**
+			 * @brief Mark the producer as gone, the consumer frees the ring once drained
+			 */
+			void retire() noexcept { m_retired.store(true, std::memory_order_release); }
+
+			[[nodiscard]] auto retired() const noexcept -> bool { return m_retired.load(std::memory_order_acquire); }
+
+		private:
+			std::unique_ptr<uint64_t[]> m_buf;
+			size_t						m_mask;
+			std::atomic<bool>			m_retired = false;
+
+			alignas(64) std::atomic<size_t> m_head = 0;
+			alignas(64) std::atomic<size_t> m_tail = 0;
+
+			[[nodiscard]] auto _at_(size_t pos) const noexcept -> uint64_t * { return &m_buf[(pos & m_mask) / 8]; }
+		};
+
+		/**
+		 * @brief Staging rings of one thread by logger id. Retires them when the thread exits.
+		 */
+		struct _StagingCache_
+		{
+			struct Entry
+			{
+				uint64_t				  id;
+				_Staging_				 *buf;
+				std::weak_ptr<_Staging_> owner; // Expires with the logger
+			};
+
+			std::vector<Entry> entries;
+
+			_StagingCache_() = default;
+
+			_StagingCache_(const _StagingCache_ &) = delete;
+
+			~_StagingCache_()
+			{
+				for (auto &e : entries)
+					if (auto buf = e.owner.lock())
+						buf->retire();
+			}
+		};
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Logger
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Logger deferring all formatting. Every thread copies the raw arguments of a call into its own staging ring,
+	 * a background thread compacts them into the file. The file describes every call site before its first record, so
+	 * decode_binary_log can turn it back into text without the executable. The ring of a thread is freed once
+	 * the thread exited and its records are written.
+	 *
+	 * File layout: "UTLBLOG1", then varints. 0 starts a site (catagory, line, format, file, argument types), any other
+	 * value n starts a record of site n - 1 followed by the zigzag timestamp delta in nanoseconds and the arguments.
+	 */
+	class BinaryLogger
+	{
+	public:
+		static constexpr std::string_view MAGIC	  = "UTLBLOG1";
+		static constexpr auto			  POLL	  = std::chrono::milliseconds(1);
+		static constexpr size_t			  STAGING = 1 << 20;
+
+		/**
+		 * @brief Open the log and start the background thread
+		 * @param path File to write to
+		 * @param staging Size of the staging ring of each thread, rounded up to a power of 2
+		 */
+		explicit BinaryLogger(std::string_view path, size_t staging = STAGING)
+			: BinaryLogger(path, staging, FilePolicy::Options())
+		{
+		}
+
+		/**
+		 * @brief Open the log and start the background thread
+		 * @param path File to write to
+		 * @param staging Size of the staging ring of each thread, rounded up to a power of 2
+		 * @param o File options. Rotation is disabled since every file needs its site definitions
+		 */
+		BinaryLogger(std::string_view path, size_t staging, FilePolicy::Options o)
+			: m_file(path, _no_rotation_(o))
+			, m_staging(std::bit_ceil(std::max<size_t>(staging, 64)))
+		{
+			m_file.write(MAGIC, Catagory::INFO);
+			m_thread = std::jthread([this](std::stop_token s) { _run_(s); });
+		}
+
+		BinaryLogger(const BinaryLogger &) = delete;
+		BinaryLogger(BinaryLogger &&)	   = delete;
+
+		~BinaryLogger()
+		{
+			m_thread.request_stop();
+			m_thread.join();
+		}
+
+		/**
+		 * @brief Copy a record into the staging ring of the calling thread. Use UTL_BLOG instead.
+		 * @param site Static information of the call
+		 * @param args Arguments matching site.types
+		 */
+		template<typename... Args>
+		void log(const LogSite &site, const Args &...args)
+		{
+			const size_t size = detail::_Staging_::HEADER + (_size_(args) + ... + 0);
+			if (size > m_staging / 2)
+				throw std::length_error("Log record larger than the staging ring.");
+
+			auto &buf = _staging_();
+			auto *p	  = buf.reserve(size);
+
+			const uint64_t header[3] = {
+				size, uint64_t(reinterpret_cast<uintptr_t>(&site)),
+				uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+							 std::chrono::system_clock::now().time_since_epoch())
+							 .count())
+			};
+			std::memcpy(p, header, sizeof header);
+			p += sizeof header;
+
+			(_stage_(p, args), ...);
+			buf.commit(size);
+		}
+
+		/**
+		 * @brief Wait until every record logged before the call is written to the file
+		 */
+		void flush()
+		{
+			const auto req = m_flush_req.fetch_add(1, std::memory_order_acq_rel) + 1;
+			for (auto done = m_flush_done.load(std::memory_order_acquire); done < req;
+				 done	   = m_flush_done.load(std::memory_order_acquire))
+				m_flush_done.wait(done, std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Number of staging rings, one for every thread that logged and hasn't exited before the last drain
+		 */
+		[[nodiscard]] auto staging_rings() -> size_t
+		{
+			std::lock_guard lock(m_mutex);
+			return m_buffers.size();
+		}
+
+	private:
+		FilePolicy m_file;
+		size_t	   m_staging;
+		uint64_t   m_id = detail::_next_logger_id_();
+
+		std::mutex										 m_mutex; // Guards m_buffers
+		std::vector<std::shared_ptr<detail::_Staging_>> m_buffers;
+
+		std::atomic<uint64_t> m_flush_req  = 0;
+		std::atomic<uint64_t> m_flush_done = 0;
+
+		std::jthread m_thread;
+
+		static auto _no_rotation_(FilePolicy::Options o) noexcept -> FilePolicy::Options
+		{
+			o.max_size = 0;
+			o.max_age  = {};
+			return o;
+		}
+
+		template<typename T>
+		static constexpr auto _size_(const T &v) noexcept -> size_t
+		{
+			if constexpr (detail::_arg_type_<T>() == STRING)
+				return 8 + (std::string_view(v).size() + 7) / 8 * 8;
+			else
+				return 8;
+		}
+
+		template<typename T>
+		static void _stage_(char *&p, const T &v) noexcept
+		{
+			constexpr auto type = detail::_arg_type_<T>();
+
+			if constexpr (type == STRING)
+			{
+				const std::string_view str(v);
+				const uint64_t		   n = str.size();
+				std::memcpy(p, &n, 8);
+				std::memcpy(p + 8, str.data(), n);
+				p += 8 + (n + 7) / 8 * 8;
+				return;
+			}
+			else if constexpr (type == FLOAT)
+			{
+				const double d = v;
+				std::memcpy(p, &d, 8);
+			}
+			else if constexpr (type == INT)
+			{
+				const int64_t i = int64_t(v);
+				std::memcpy(p, &i, 8);
+			}
+			else
+			{
+				const uint64_t u = uint64_t(v);
+				std::memcpy(p, &u, 8);
+			}
+
+			p += 8;
+		}
+
+		/**
+		 * @brief Find the staging ring of the calling thread, creating it on first use. Entries of destroyed loggers are
+		 * pruned on creation.
+		 */
+		auto _staging_() -> detail::_Staging_ &
+		{
+			thread_local detail::_StagingCache_ cache;
+
+			for (const auto &e : cache.entries)
+				if (e.id == m_id)
+					return *e.buf;
+
+			std::erase_if(cache.entries, [](const auto &e) { return e.owner.expired(); });
+
+			std::lock_guard lock(m_mutex);
+			const auto	   &buf = m_buffers.emplace_back(std::make_shared<detail::_Staging_>(m_staging));
+			cache.entries.push_back({ .id = m_id, .buf = buf.get(), .owner = buf });
+			return *buf;
+		}
+
+		void _run_(std::stop_token stop)
+		{
+			std::unordered_map<const LogSite *, uint64_t> ids;
+			std::string									  out;
+			int64_t										  last = 0;
+
+			auto encode = [&](const char *rec) {
+				uint64_t header[3];
+				std::memcpy(header, rec, sizeof header);
+				const auto *site = reinterpret_cast<const LogSite *>(uintptr_t(header[1]));
+
+				auto [it, added] = ids.try_emplace(site, ids.size());
+				if (added)
+				{
+					detail::_put_varint_(out, 0);
+					out += char(site->catagory);
+					detail::_put_varint_(out, site->line);
+					detail::_put_varint_(out, site->format.size());
+					out += site->format;
+					detail::_put_varint_(out, site->file.size());
+					out += site->file;
+					detail::_put_varint_(out, site->types.size());
+					out.append(reinterpret_cast<const char *>(site->types.data()), site->types.size());
+				}
+
+				detail::_put_varint_(out, it->second + 1);
+				detail::_put_varint_(out, detail::_zigzag_(int64_t(header[2]) - last));
+				last = int64_t(header[2]);
+
+				const char *p = rec + sizeof header;
+				for (const auto t : site->types)
+				{
+					uint64_t v;
+					std::memcpy(&v, p, 8);
+					p += 8;
+
+					switch (t)
+					{
+					case INT: detail::_put_varint_(out, detail::_zigzag_(int64_t(v))); break;
+					case FLOAT: out.append(reinterpret_cast<const char *>(&v), 8); break;
+					case STRING:
+						detail::_put_varint_(out, v);
+						out.append(p, v);
+						p += (v + 7) / 8 * 8;
+						break;
+					default: detail::_put_varint_(out, v); break;
+					}
+				}
+			};
+
+			for (bool stopping = false;;)
+			{
+				stopping	   = stop.stop_requested();
+				const auto req = m_flush_req.load(std::memory_order_acquire);
+
+				{
+					std::lock_guard lock(m_mutex);
+					for (auto it = m_buffers.begin(); it != m_buffers.end();)
+					{
+						// Checked before draining, so every record of a retired ring is seen
+						const bool retired = (*it)->retired();
+						(*it)->drain(encode);
+						it = retired ? m_buffers.erase(it) : it + 1;
+					}
+				}
+
+				if (!out.empty())
+				{
+					m_file.write(out, Catagory::INFO);
+					m_file.close();
+					out.clear();
+				}
+
+				if (req != m_flush_done.load(std::memory_order_relaxed) || stopping)
+				{
+					m_file.flush();
+					m_flush_done.store(req, std::memory_order_release);
+					m_flush_done.notify_all();
+				}
+
+				if (stopping)
+					return;
+
+				if (m_flush_req.load(std::memory_order_acquire) == req)
+					std::this_thread::sleep_for(POLL);
+			}
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Decoder
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Turn a binary log back into the text format of Logger
+	 *
+	 * @param data Content of the binary log
+	 * @param f Callback taking each line including its '\n'
+	 */
+	template<typename F>
+	void decode_binary_log(std::string_view data, F &&f)
+	{
+		if (!data.starts_with(BinaryLogger::MAGIC))
+			throw std::runtime_error("Not a binary log.");
+
+		struct Site
+		{
+			Catagory			 catagory;
+			std::string_view	 format;
+			std::vector<uint8_t> types;
+		};
+
+		std::vector<Site>  sites;
+		std::string		   line;
+		int64_t			   time = 0;
+		TimestampFormatter stamp;
+
+		const char *p	= data.data() + BinaryLogger::MAGIC.size();
+		const char *end = data.data() + data.size();
+
+		auto get_str = [&] {
+			const auto n = detail::_get_varint_(p, end);
+			if (size_t(end - p) < n)
+				throw std::runtime_error("Malformed binary log.");
+
+			const std::string_view res(p, n);
+			p += n;
+			return res;
+		};
+
+		while (p != end)
+		{
+			const auto id = detail::_get_varint_(p, end);
+
+			if (id == 0)
+			{
+				if (p == end)
+					throw std::runtime_error("Malformed binary log.");
+
+				auto &s	   = sites.emplace_back();
+				s.catagory = Catagory(uint8_t(*p++));
+				detail::_get_varint_(p, end); // Line
+				s.format = get_str();
+				get_str(); // File
+				const auto types = get_str();
+				s.types.assign(types.begin(), types.end());
+				continue;
+			}
+
+			if (id > sites.size())
+				throw std::runtime_error("Malformed binary log.");
+
+			const auto &s = sites[id - 1];
+			time += detail::_unzigzag_(detail::_get_varint_(p, end));
+
+			line = stamp.format(std::chrono::system_clock::time_point(
+				std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time))));
+			line += detail::_catagory_name_(s.catagory);
+
+			auto fmt = s.format;
+			for (const auto t : s.types)
+			{
+				const auto ph = fmt.find("{}");
+				line += fmt.substr(0, ph);
+				fmt.remove_prefix(ph + 2);
+
+				char buf[32];
+				switch (t)
+				{
+				case INT:
+					line.append(buf, std::to_chars(buf, buf + sizeof buf, detail::_unzigzag_(detail::_get_varint_(p, end))).ptr);
+					break;
+				case UINT: line.append(buf, std::to_chars(buf, buf + sizeof buf, detail::_get_varint_(p, end)).ptr); break;
+				case FLOAT:
+				{
+					if (end - p < 8)
+						throw std::runtime_error("Malformed binary log.");
+
+					double d;
+					std::memcpy(&d, p, 8);
+					p += 8;
+					line.append(buf, std::to_chars(buf, buf + sizeof buf, d).ptr);
+					break;
+				}
+				case BOOL: line += detail::_get_varint_(p, end) ? "true" : "false"; break;
+				case CHAR: line += char(detail::_get_varint_(p, end)); break;
+				case STRING: line += get_str(); break;
+				default: throw std::runtime_error("Malformed binary log.");
+				}
+			}
+
+			line += fmt;
+			line += '\n';
+			f(std::string_view(line));
+		}
+	}
+
+} // namespace utl
+
+#endif
+
+#endif
@@ -5,6 +5,10 @@
 #include <iostream>
 #include <vector>
 #include <array>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include "FileSystem.h"
 #include "Parse.h"
 
 namespace utl
@@ -22,83 +26,496 @@ namespace utl
 		std::array<uint32_t *, flag_n>				flag_values;
 	};
 
-	template<size_t n0, size_t n1, size_t n2, size_t n3>
-	void arg_to_data(int argc, const char *const *argv, Arguments<n0, n1, n2, n3> &&k)
+	/**
+	 * @brief Option names for bind_args, the values are bound through ArgTargets
+	 */
+	template<size_t required_n, size_t optional_n, size_t short_optional_n, size_t flag_n>
+	struct ArgNames
 	{
-		++argv; // Skip executable loc
-		--argc;
+		static constexpr size_t required_count = required_n;
 
-		auto inbound = [argv, argc](auto i, const char *str) { // Cancel on missing arguments
-			if (++i == argv + argc)
-				throw std::out_of_range(str);
-			return i;
-		};
+		std::array<std::string_view, optional_n> optional_names;
+		std::array<char, short_optional_n>		 optional_short_names;
+		std::array<char, flag_n>				 flag_names;
+	};
 
-		auto req_i = k.required_values.begin();
+	namespace detail
+	{
+		/**
+		 * @brief Default positional callback, rejecting values beyond the required ones
+		 */
+		struct _NoPositional_
+		{
+			[[noreturn]] void operator()(std::string_view) const
+			{
+				throw std::out_of_range("More arguments than expected.");
+			}
+		};
 
-		for (auto i = argv; i != argv + argc; ++i)
+		template<typename Iter, size_t n0, size_t n1, size_t n2, size_t n3, typename F>
+		void _arg_to_data_(Iter begin, Iter end, Arguments<n0, n1, n2, n3> &k, F &&positional)
 		{
-			SequentialParser p(*i);
+			auto inbound = [end](auto i, const char *str) { // Cancel on missing arguments
+				if (++i == end)
+					throw std::out_of_range(str);
+				return i;
+			};
 
-			// Is REQUIRED
-			if (p.current() != '-' || p.total_size() == 1) // No '-' or size to small for option -> required
+			auto req_i = k.required_values.begin();
+
+			for (auto i = begin; i != end; ++i)
 			{
-				if (req_i == k.required_values.end()) // Check for overflow
-					throw std::out_of_range("More arguments than expected.");
+				SequentialParser p(*i);
+
+				// Is REQUIRED
+				if (p.current() != '-' || p.total_size() == 1) // No '-' or size to small for option -> required
+				{
+					if (req_i == k.required_values.end()) // Overflow goes to the positional callback
+						positional(p.rest());
+					else
+						**req_i++ = p.rest(); // Store required
+
+					continue;
+				}
 
-				**req_i++ = p.rest(); // Store required
+				p.skip_for(1); // Skip the '-'
 
-				continue;
+				// Is OPTIONAL
+				if (p.current() == '-') // "--" must be
+				{
+					p.skip_for(1); // Skip the second '-'
+
+					const auto opt = std::find(k.optional_names.begin(), k.optional_names.end(),
+											   p.rest()); // Find if string start with option name.
+
+					if (opt == k.optional_names.end()) // Error on not found
+						throw std::logic_error("Option not found.");
+
+					const auto v =
+						*(i = inbound(i, "Missing option value.")); // Get value from next to string or next string
+
+					*k.optional_values[std::distance(k.optional_names.begin(), opt)] = v; // Save the value
+					continue;
+				}
+
+				while (!p.at_end()) // Go through each character
+				{
+					const auto ch = p.get();
+
+					// Is FLAG
+					if (const auto f = std::find(k.flag_names.begin(), k.flag_names.end(), ch); f != k.flag_names.end())
+					{
+						++*k.flag_values[std::distance(k.flag_names.begin(), f)];
+						continue;
+					}
+
+					// Is OPTIONAL SHORT
+					const auto c = std::find(k.optional_short_names.begin(), k.optional_short_names.end(), ch);
+
+					if (c == k.optional_short_names.end())
+						throw std::logic_error("Option not found.");
+
+					const auto v = p.at_end() ? std::string_view(*(i = inbound(i, "Missing option value.")))
+											  : p.rest(); // Collect its value from next to string or next string
+
+					*k.optional_short_values[std::distance(k.optional_short_names.begin(), c)] = v; // Save the value
+					break;
+				}
 			}
 
-			p.skip_for(1); // Skip the '-'
+			if (req_i != k.required_values.end()) // Check if all necessary commands gotten
+				throw std::runtime_error("Missing required values.");
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Parse the command line into the variables of k
+	 *
+	 * @param argc Argument count
+	 * @param argv Arguments, first one being the executable
+	 * @param k Names and targets of the arguments
+	 * @param positional Callback receiving the positional values beyond the required ones. Throws by default
+	 */
+	template<size_t n0, size_t n1, size_t n2, size_t n3, typename F = detail::_NoPositional_>
+	void arg_to_data(int argc, const char *const *argv, Arguments<n0, n1, n2, n3> &&k, F &&positional = {})
+	{
+		detail::_arg_to_data_(argv + 1, argv + argc, k, positional);
+	}
 
-			// Is OPTIONAL
-			if (p.current() == '-') // "--" must be
+	// -----------------------------------------------------------------------------
+	// Typed Binding
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		template<typename T>
+		struct _is_duration_ : std::false_type
+		{
+		};
+
+		template<typename Rep, typename Period>
+		struct _is_duration_<std::chrono::duration<Rep, Period>> : std::true_type
+		{
+		};
+
+		template<typename T>
+		concept _named_enum_ = std::is_enum_v<T> && requires(T e)
+		{
 			{
-				p.skip_for(1); // Skip the second '-'
+				enum_names(e)
+			};
+		};
+
+		template<typename T>
+		auto _from_chars_(std::string_view str, T &v) noexcept -> bool
+		{
+			const auto res = std::from_chars(str.data(), str.data() + str.size(), v);
+			return res.ec == std::errc() && res.ptr == str.data() + str.size();
+		}
+
+		/**
+		 * @brief Parse a duration with an optional unit suffix (ns, us, ms, s, min, h). Without one the unit of the
+		 * target is used.
+		 */
+		template<typename Rep, typename Period>
+		auto _from_duration_(std::string_view str, std::chrono::duration<Rep, Period> &v) noexcept -> bool
+		{
+			using namespace std::chrono;
+			using num_t = std::conditional_t<std::is_floating_point_v<Rep>, Rep, int64_t>;
+
+			const auto unit = str.find_first_not_of("+-0123456789.");
+			num_t	   n;
+			if (!_from_chars_(str.substr(0, unit), n))
+				return false;
+
+			const auto suffix = unit == std::string_view::npos ? std::string_view() : str.substr(unit);
+
+			if (suffix.empty())
+				v = duration<Rep, Period>(Rep(n));
+			else if (suffix == "ns")
+				v = duration_cast<duration<Rep, Period>>(duration<num_t, std::nano>(n));
+			else if (suffix == "us")
+				v = duration_cast<duration<Rep, Period>>(duration<num_t, std::micro>(n));
+			else if (suffix == "ms")
+				v = duration_cast<duration<Rep, Period>>(duration<num_t, std::milli>(n));
+			else if (suffix == "s")
+				v = duration_cast<duration<Rep, Period>>(duration<num_t>(n));
+			else if (suffix == "min")
+				v = duration_cast<duration<Rep, Period>>(duration<num_t, std::ratio<60>>(n));
+			else if (suffix == "h")
+				v = duration_cast<duration<Rep, Period>>(duration<num_t, std::ratio<3600>>(n));
+			else
+				return false;
+
+			return true;
+		}
+
+		/**
+		 * @brief Convert an argument to the target type
+		 * @return false if the argument doesn't fit the type
+		 */
+		template<typename T>
+		auto _from_arg_(std::string_view str, T &v) -> bool
+		{
+			if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>)
+				v = str;
+			else if constexpr (_named_enum_<T>)
+			{
+				for (const auto &[name, e] : enum_names(T()))
+					if (name == str)
+					{
+						v = e;
+						return true;
+					}
+
+				return false;
+			}
+			else if constexpr (std::is_enum_v<T>)
+			{
+				std::underlying_type_t<T> n;
+				if (!_from_chars_(str, n))
+					return false;
+				v = T(n);
+			}
+			else if constexpr (_is_duration_<T>::value)
+				return _from_duration_(str, v);
+			else
+				return _from_chars_(str, v);
+
+			return true;
+		}
+
+		template<typename T>
+		concept _arg_type_ = std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string> || std::is_enum_v<T>
+			|| _is_duration_<T>::value || ((std::integral<T> && !std::is_same_v<T, bool>) || std::floating_point<T>);
 
-				const auto opt = std::find(k.optional_names.begin(), k.optional_names.end(),
-										   p.rest()); // Find if string start with option name.
+		constexpr auto _hash_name_(std::string_view str) noexcept -> size_t
+		{
+			uint64_t h = 14695981039346656037ULL; // FNV-1a
+			for (const auto c : str) h = (h ^ uint8_t(c)) * 1099511628211ULL;
+			return size_t(h ^ (h >> 32));
+		}
 
-				if (opt == k.optional_names.end()) // Error on not found
-					throw std::logic_error("Option not found.");
+		/**
+		 * @brief Lookup tables of the option names of an ArgNames object. Long names are in an open addressing hash
+		 * table, short names and flags are in a table indexed by the character.
+		 */
+		template<const auto &args>
+		struct _ArgTable_
+		{
+			static constexpr size_t LONG_SIZE = std::bit_ceil(args.optional_names.size() * 2 + 1);
 
-				const auto v =
-					*(i = inbound(i, "Missing option value.")); // Get value from next to string or next string
+			std::array<uint16_t, LONG_SIZE> names {}; // Option index + 1, 0 is empty
+			std::array<int16_t, 256>		chars {}; // Short option index + 1, -(flag index + 1) for flags
 
-				*k.optional_values[std::distance(k.optional_names.begin(), opt)] = v; // Save the value
-				continue;
+			constexpr _ArgTable_() noexcept
+			{
+				for (size_t i = 0; i < args.optional_names.size(); ++i)
+				{
+					auto h = _hash_name_(args.optional_names[i]);
+					while (names[h & (LONG_SIZE - 1)] != 0) ++h;
+					names[h & (LONG_SIZE - 1)] = uint16_t(i + 1);
+				}
+
+				for (size_t i = 0; i < args.optional_short_names.size(); ++i)
+					chars[uint8_t(args.optional_short_names[i])] = int16_t(i + 1);
+				for (size_t i = 0; i < args.flag_names.size(); ++i)
+					chars[uint8_t(args.flag_names[i])] = int16_t(-int(i) - 1);
 			}
 
-			while (!p.at_end()) // Go through each character
+			/**
+			 * @brief Find a long option
+			 * @return index or null object if not found
+			 */
+			[[nodiscard]] constexpr auto find(std::string_view str) const noexcept -> std::optional<size_t>
 			{
-				const auto ch = p.get();
+				for (auto h = _hash_name_(str);; ++h)
+				{
+					const auto i = names[h & (LONG_SIZE - 1)];
+					if (i == 0)
+						return std::nullopt;
+					if (args.optional_names[i - 1] == str)
+						return i - 1;
+				}
+			}
+		};
+	} // namespace detail
+
+	/**
+	 * @brief Typed reference to a variable receiving an argument. Accepts std::string_view (pointing into argv),
+	 * std::string, arithmetic types, std::chrono::duration and enums. Enums are looked up by name if enum_names(E) is
+	 * found by ADL, returning a range of (std::string_view, E) pairs, otherwise they are read as their underlying
+	 * integer.
+	 */
+	class ArgRef
+	{
+	public:
+		template<typename T>
+		requires detail::_arg_type_<T> ArgRef(T &v)
+		noexcept
+			: m_ptr(&v)
+			, m_set([](void *p, std::string_view str) { return detail::_from_arg_(str, *static_cast<T *>(p)); })
+		{
+		}
+
+		/**
+		 * @brief Convert and store an argument
+		 * @return false if the argument doesn't fit the type
+		 */
+		auto set(std::string_view str) const -> bool { return m_set(m_ptr, str); }
+
+	private:
+		void *m_ptr;
+		bool (*m_set)(void *, std::string_view);
+	};
+
+	/**
+	 * @brief Targets of the names in an ArgNames object
+	 * @tparam args ArgNames object
+	 */
+	template<const auto &args>
+	struct ArgTargets
+	{
+		std::array<ArgRef, args.required_count>				 required_values;
+		std::array<ArgRef, args.optional_names.size()>		 optional_values;
+		std::array<ArgRef, args.optional_short_names.size()> optional_short_values;
+		std::array<uint32_t *, args.flag_names.size()>		 flag_values;
+	};
+
+	namespace detail
+	{
+		template<const auto &args, typename Iter, typename F>
+		void _bind_args_(Iter begin, Iter end, const ArgTargets<args> &t, F &&positional)
+		{
+			static constexpr _ArgTable_<args> table;
+
+			auto set = [](const ArgRef &r, std::string_view str) {
+				if (!r.set(str))
+					throw std::invalid_argument("Invalid option value.");
+			};
+
+			auto req_i = t.required_values.begin();
+
+			for (auto i = begin; i != end; ++i)
+			{
+				const std::string_view arg(*i);
+
+				// Is REQUIRED, negative numbers included
+				if (arg.size() < 2 || arg[0] != '-' || (table.chars[uint8_t(arg[1])] == 0 && _is_digit_(arg[1])))
+				{
+					if (req_i == t.required_values.end())
+						positional(arg);
+					else
+						set(*req_i++, arg);
+
+					continue;
+				}
 
-				// Is FLAG
-				if (const auto f = std::find(k.flag_names.begin(), k.flag_names.end(), ch); f != k.flag_names.end())
+				// Is OPTIONAL
+				if (arg[1] == '-')
 				{
-					++*k.flag_values[std::distance(k.flag_names.begin(), f)];
+					const auto opt = table.find(arg.substr(2));
+					if (!opt)
+						throw std::logic_error("Option not found.");
+					if (++i == end)
+						throw std::out_of_range("Missing option value.");
+
+					set(t.optional_values[*opt], *i);
 					continue;
 				}
 
-				// Is OPTIONAL SHORT
-				const auto c = std::find(k.optional_short_names.begin(), k.optional_short_names.end(), ch);
+				for (size_t c = 1; c < arg.size(); ++c)
+				{
+					const auto k = table.chars[uint8_t(arg[c])];
 
-				if (c == k.optional_short_names.end())
-					throw std::logic_error("Option not found.");
+					// Is FLAG
+					if (k < 0)
+					{
+						++*t.flag_values[-k - 1];
+						continue;
+					}
 
-				const auto v = p.at_end() ? *(i = inbound(i, "Missing option value."))
-										  : p.rest(); // Collect its value from next to string or next string
+					// Is OPTIONAL SHORT
+					if (k == 0)
+						throw std::logic_error("Option not found.");
 
-				*k.optional_short_values[std::distance(k.optional_short_names.begin(), c)] = v; // Save the value
-				break;
+					if (c + 1 < arg.size())
+						set(t.optional_short_values[k - 1], arg.substr(c + 1));
+					else if (++i == end)
+						throw std::out_of_range("Missing option value.");
+					else
+						set(t.optional_short_values[k - 1], *i);
+					break;
+				}
 			}
+
+			if (req_i != t.required_values.end())
+				throw std::runtime_error("Missing required values.");
 		}
+	} // namespace detail
 
-		if (req_i != k.required_values.end()) // Check if all necessary commands gotten
-			throw std::runtime_error("Missing required values.");
+	/**
+	 * @brief Bind arguments to typed variables without copying. Same syntax as arg_to_data, but options are found
+	 * through tables built at compile time and values are converted in place.
+	 *
+	 * @tparam args ArgNames object with the option names
+	 * @param argc Argument count
+	 * @param argv Arguments, must outlive bound std::string_view targets
+	 * @param t Variables to bind to
+	 * @param positional Callback receiving the positional values beyond the required ones. Throws by default
+	 */
+	template<const auto &args, typename F = detail::_NoPositional_>
+	void bind_args(int argc, const char *const *argv, const ArgTargets<args> &t, F &&positional = {})
+	{
+		detail::_bind_args_<args>(argv + 1, argv + argc, t, positional);
+	}
+
+#if defined unix || defined __unix || defined __unix__
+	// -----------------------------------------------------------------------------
+	// Response Files
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Arguments with "@file" response files expanded in place. The files are mapped and split at whitespace,
+	 * quotes ("..." or '...') keep whitespace inside of a token. Response files may reference further ones. Tokens point
+	 * into argv or the mapped files and stay valid as long as the list exists.
+	 */
+	class ArgList
+	{
+	public:
+		static constexpr size_t MAX_DEPTH = 16;
+
+		/**
+		 * @brief Expand the command line
+		 * @param argc Argument count
+		 * @param argv Arguments, first one being the executable
+		 */
+		ArgList(int argc, const char *const *argv)
+		{
+			m_args.reserve(argc);
+			for (int i = 1; i < argc; ++i) _add_(argv[i], 0);
+		}
+
+		[[nodiscard]] auto begin() const noexcept { return m_args.begin(); }
+		[[nodiscard]] auto end() const noexcept { return m_args.end(); }
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_args.size(); }
+		[[nodiscard]] auto operator[](size_t i) const noexcept -> std::string_view { return m_args[i]; }
+
+	private:
+		std::vector<MappedFile>		  m_files;
+		std::vector<std::string_view> m_args;
+
+		void _add_(std::string_view arg, size_t depth)
+		{
+			if (arg.size() < 2 || arg[0] != '@')
+			{
+				m_args.emplace_back(arg);
+				return;
+			}
+
+			if (depth == MAX_DEPTH)
+				throw std::runtime_error("Response files nested too deep.");
+
+			const auto &file = m_files.emplace_back(std::string(arg.substr(1)).c_str());
+			m_args.reserve(m_args.size() + file.size() / 32); // Rough guess to skip most regrowths
+
+			SequentialParser p(file.view());
+			for (p.skip_space(); !p.at_end(); p.skip_space())
+			{
+				if (const auto q = p.current(); q == '"' || q == '\'')
+				{
+					p.skip_for(1);
+					const auto tok = p.get_until(q);
+					if (!tok)
+						throw std::runtime_error("Unterminated quote in response file.");
+
+					p.skip_for(1);
+					m_args.emplace_back(*tok); // Quoted tokens aren't expanded
+				}
+				else
+					_add_(p.take(), depth + 1);
+			}
+		}
+	};
+
+	/**
+	 * @brief arg_to_data on an expanded argument list
+	 */
+	template<size_t n0, size_t n1, size_t n2, size_t n3, typename F = detail::_NoPositional_>
+	void arg_to_data(const ArgList &l, Arguments<n0, n1, n2, n3> &&k, F &&positional = {})
+	{
+		detail::_arg_to_data_(l.begin(), l.end(), k, positional);
+	}
+
+	/**
+	 * @brief bind_args on an expanded argument list
+	 */
+	template<const auto &args, typename F = detail::_NoPositional_>
+	void bind_args(const ArgList &l, const ArgTargets<args> &t, F &&positional = {})
+	{
+		detail::_bind_args_<args>(l.begin(), l.end(), t, positional);
 	}
+#endif
 } // namespace utl
 
 #endif
\ No newline at end of file
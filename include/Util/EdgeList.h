@@ -0,0 +1,194 @@
+#if not defined _UTILLIB_EDGELIST_
+#define _UTILLIB_EDGELIST_
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Graph.h"
+#include "Parse.h"
+#include "Records.h"
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Structures
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Graph owning its compressed sparse rows
+	 * @tparam EdgeT Edge or WeighedEdge
+	 */
+	template<same_as<Edge, WeighedEdge> EdgeT>
+	struct CSRGraph
+	{
+		std::vector<EdgeT>	edges; // Edges sorted by source
+		std::vector<size_t> idx;   // Range separators of each source
+
+		/**
+		 * @brief Get a view usable by the graph algorithms
+		 * @return Graph
+		 */
+		[[nodiscard]] auto graph() const noexcept -> Graph<const EdgeT *, const size_t *>
+		{
+			return { .edges = edges.data(), .idx = idx.data(), .size = idx.size() - 1 };
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Loader
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		inline void _skip_blank_(SequentialParser &p) noexcept
+		{
+			while (!p.at_end() && (p.current() == ' ' || p.current() == '\t' || p.current() == '\r')) p.skip_for(1);
+		}
+
+		/**
+		 * @brief Parse every "src dst [weight]" line of a chunk. Lines starting with '#' or '%' are comments.
+		 * @param f Callback taking (src, dst, weight)
+		 */
+		template<typename F>
+		void _parse_edges_(std::string_view chunk, bool weighed, F &&f)
+		{
+			SequentialParser p(chunk);
+
+			for (p.skip_space(); !p.at_end(); p.skip_space())
+			{
+				if (p.current() == '#' || p.current() == '%')
+				{
+					const auto nl = p.find('\n');
+					p.seek(nl ? *nl : p.total_size());
+					continue;
+				}
+
+				const auto src = p.get<size_t>();
+				_skip_blank_(p);
+				const auto dst = p.get<size_t>();
+				_skip_blank_(p);
+
+				std::optional<uint32_t> weight = 1U;
+				if (weighed && !p.at_end() && p.current() != '\n')
+				{
+					weight = p.get<uint32_t>();
+					_skip_blank_(p);
+				}
+
+				if (!src || !dst || !weight || (!p.at_end() && p.current() != '\n'))
+					throw std::runtime_error("Malformed edge list line.");
+
+				f(*src, *dst, *weight);
+			}
+		}
+
+		/**
+		 * @brief Split text into chunks beginning at line starts
+		 */
+		inline auto _split_lines_(std::string_view text, size_t parts) -> std::vector<size_t>
+		{
+			auto res = _split_(text.size(), parts);
+
+			for (size_t i = 1; i < parts; ++i)
+			{
+				const auto nl = find_char(text, '\n', std::max(res[i], res[i - 1] + 1) - 1);
+				res[i]		  = nl == std::string_view::npos ? text.size() : nl + 1;
+			}
+
+			return res;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Load a whitespace separated "src dst [weight]" edge list into CSR form. Chunks of the text are parsed in
+	 * parallel twice: first for the node count, keeping only the source of each edge to count degrees, then to scatter
+	 * the edges into place. The edges of each node are sorted by destination afterwards so the result doesn't depend
+	 * on the thread count.
+	 *
+	 * The sources take 8 bytes per edge, up to 16 with vector growth, and are freed before the edges are allocated. Peak
+	 * memory is therefore the final CSR for WeighedEdge (16 bytes per edge) and at most idx plus twice the edges for
+	 * Edge (8 bytes per edge).
+	 *
+	 * @tparam EdgeT Edge or WeighedEdge. Missing weights default to 1
+	 * @param text Edge list, for example a MappedFile
+	 * @param threads Amount of threads to use
+	 * @return Graph with max(node id) + 1 nodes
+	 */
+	template<same_as<Edge, WeighedEdge> EdgeT = Edge>
+	[[nodiscard]] auto load_edge_list(std::string_view text, size_t threads = std::thread::hardware_concurrency())
+		-> CSRGraph<EdgeT>
+	{
+		UTL_PROFILE_SCOPE("load_edge_list");
+
+		constexpr bool weighed	 = std::is_same_v<EdgeT, WeighedEdge>;
+		constexpr auto MIN_CHUNK = size_t(1) << 20;
+
+		threads			 = std::max<size_t>(threads, 1);
+		const auto parts = std::max<size_t>(1, std::min(threads * 4, text.size() / MIN_CHUNK));
+		const auto split = detail::_split_lines_(text, parts);
+
+		auto	   chunk = [&](size_t i) { return text.substr(split[i], split[i + 1] - split[i]); };
+
+		// Parse once for the node count, keeping only the sources of each chunk
+		std::vector<std::vector<size_t>> sources(parts);
+		std::vector<size_t>				 nodes(parts, 0);
+
+		detail::_run_parallel_(parts, threads, [&](size_t i) {
+			size_t n = 0;
+			detail::_parse_edges_(chunk(i), weighed, [&](size_t s, size_t d, uint32_t) {
+				n = std::max({ n, s + 1, d + 1 });
+				sources[i].push_back(s);
+			});
+			nodes[i] = n;
+		});
+
+		CSRGraph<EdgeT> res;
+		res.idx.resize(*std::max_element(nodes.begin(), nodes.end()) + 1, 0);
+
+		// Degrees shifted by one so the prefix sum gives the range begins. The sources are freed before the edges are
+		// allocated, so they never coexist
+		detail::_run_parallel_(parts, threads, [&](size_t i) {
+			for (const auto s : sources[i]) std::atomic_ref(res.idx[s + 1]).fetch_add(1, std::memory_order_relaxed);
+			std::vector<size_t>().swap(sources[i]);
+		});
+
+		for (size_t i = 1; i < res.idx.size(); ++i) res.idx[i] += res.idx[i - 1];
+
+		// Parse again and scatter straight into the edges
+		res.edges.resize(res.idx.back());
+		std::vector<size_t> cursor(res.idx.begin(), res.idx.end() - 1);
+
+		detail::_run_parallel_(parts, threads, [&](size_t i) {
+			detail::_parse_edges_(chunk(i), weighed, [&](size_t s, size_t d, uint32_t w) {
+				const auto at = std::atomic_ref(cursor[s]).fetch_add(1, std::memory_order_relaxed);
+
+				if constexpr (weighed)
+					res.edges[at] = { .dest = d, .weight = w };
+				else
+					res.edges[at] = { .dest = d };
+			});
+		});
+
+		// Sort neighbors
+		const auto n = res.idx.size() - 1;
+		detail::_run_parallel_(parts, threads, [&](size_t i) {
+			for (auto node = n * i / parts; node < n * (i + 1) / parts; ++node)
+				std::sort(res.edges.begin() + res.idx[node], res.edges.begin() + res.idx[node + 1],
+						  [](const EdgeT &a, const EdgeT &b) {
+							  if constexpr (weighed)
+								  return std::tie(a.dest, a.weight) < std::tie(b.dest, b.weight);
+							  else
+								  return a.dest < b.dest;
+						  });
+		});
+
+		return res;
+	}
+
+} // namespace utl
+
+#endif
@@ -7,6 +7,26 @@
 #include <ctime>
 #include <tuple>
 #include <iostream>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined unix || defined __unix || defined __unix__
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
 
 #ifndef NDEBUG
 #define ASSERT(cond, msg)                                                                               \
@@ -22,6 +42,22 @@
 #define ASSERT(cond, msg)
 #endif
 
+#ifndef UTL_LOG_MIN_SEVERITY
+#define UTL_LOG_MIN_SEVERITY INFO // Least severe catagory compiled in
+#endif
+
+/**
+ * @brief Log a stream with a catagory known at compile time. Below UTL_LOG_MIN_SEVERITY the whole statement is discarded,
+ * the streamed expressions aren't evaluated.
+ * Usage: UTL_LOG(log, utl::WARN) << "value " << v;
+ */
+#define UTL_LOG(logger, catagory)                       \
+	if constexpr ((catagory) < ::utl::LOG_MIN_SEVERITY) \
+	{                                                   \
+	}                                                   \
+	else                                                \
+		(logger).write(catagory)
+
 namespace utl
 {
 	/**
@@ -36,6 +72,95 @@ namespace utl
 		FATAL
 	};
 
+	/**
+	 * @brief Records of less severe catagories are dropped by every logger
+	 */
+	inline constexpr Catagory LOG_MIN_SEVERITY = Catagory::UTL_LOG_MIN_SEVERITY;
+
+	/**
+	 * @brief Formats timestamps with microseconds as "YYYY-MM-DD HH:MM:SS.uuuuuu ". The formatted date and time is cached
+	 * so mostly only the sub-second digits are written.
+	 */
+	class TimestampFormatter
+	{
+	public:
+		static constexpr size_t SIZE = 27;
+
+		/**
+		 * @brief Format a time
+		 * @param t Time to format
+		 * @return Timestamp, valid until the next call
+		 */
+		auto format(std::chrono::system_clock::time_point t) noexcept -> std::string_view
+		{
+			const auto us  = std::chrono::duration_cast<std::chrono::microseconds>(t.time_since_epoch()).count();
+			const auto sec = us / 1'000'000 - (us % 1'000'000 < 0);
+			auto	   sub = us - sec * 1'000'000;
+
+			if (sec != m_sec)
+			{
+				const auto tt = std::time_t(sec);
+				tm		   time;
+#ifdef __linux__
+				gmtime_r(&tt, &time);
+#elif _WIN32
+				gmtime_s(&time, &tt);
+#endif // __linux__
+				std::strftime(m_buf, 20, "%Y-%m-%d %H:%M:%S", &time);
+				m_buf[19] = '.';
+				m_buf[26] = ' ';
+				m_sec	  = sec;
+			}
+
+			for (size_t i = 26; i-- > 20; sub /= 10) m_buf[i] = char('0' + sub % 10);
+
+			return { m_buf, SIZE };
+		}
+
+	private:
+		char	m_buf[SIZE];
+		int64_t m_sec = std::numeric_limits<int64_t>::min();
+	};
+
+	namespace detail
+	{
+		constexpr auto _catagory_name_(Catagory c) noexcept -> std::string_view
+		{
+			switch (c)
+			{
+			case Catagory::INFO: return "[INFO] ";
+			case Catagory::WARN: return "[WARN] ";
+			case Catagory::ERR: return "[ERROR] ";
+			case Catagory::FATAL: return "[FATAL] ";
+			case Catagory::SUCCESS: return "[SUCCESS] ";
+			default: return "";
+			}
+		}
+
+		/**
+		 * @brief Append a streamable value to a string
+		 */
+		template<typename T>
+		void _append_(std::string &str, const T &v)
+		{
+			if constexpr (std::is_convertible_v<const T &, std::string_view>)
+				str += std::string_view(v);
+			else if constexpr (std::is_same_v<T, char>)
+				str += v;
+			else if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+			{
+				char buf[32];
+				str.append(buf, std::to_chars(buf, buf + sizeof buf, v).ptr);
+			}
+			else
+			{
+				std::ostringstream os;
+				os << v;
+				str += os.str();
+			}
+		}
+	} // namespace detail
+
 	template<typename T>
 	concept Policy = requires(T t)
 	{
@@ -57,6 +182,9 @@ namespace utl
 
 			~_Stream_()
 			{
+				if (m_log == nullptr)
+					return;
+
 				m_log->_write_buffer_("\n", Catagory::INFO);
 				m_log->_close_buffer_();
 			}
@@ -64,7 +192,8 @@ namespace utl
 			template<typename T>
 			auto operator<<(T &&v) -> auto &
 			{
-				m_log->_write_buffer_(std::move(v), Catagory::INFO);
+				if (m_log != nullptr)
+					m_log->_write_buffer_(std::move(v), Catagory::INFO);
 				return *this;
 			}
 
@@ -93,6 +222,9 @@ namespace utl
 		 */
 		auto write(Catagory c)
 		{
+			if (c < LOG_MIN_SEVERITY)
+				return _Stream_(nullptr);
+
 			_open_buffer_();
 
 			_write_time_();
@@ -118,6 +250,9 @@ namespace utl
 		 */
 		void write(Catagory c, std::string_view val)
 		{
+			if (c < LOG_MIN_SEVERITY)
+				return;
+
 			_open_buffer_();
 
 			_write_time_();
@@ -131,53 +266,577 @@ namespace utl
 
 	private:
 		std::tuple<Policies...> m_p;
+		TimestampFormatter		m_time;
+
+		void _write_time_() { _write_buffer_(m_time.format(std::chrono::system_clock::now()), Catagory::INFO); }
 
-		void _write_time_()
+		void _write_catagory_(Catagory c) { _write_buffer_(detail::_catagory_name_(c), c); }
+
+		template<typename T>
+		void _write_buffer_(T &&b, Catagory c)
 		{
-			const auto t = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-			char	   buf[21];
+			std::apply([&b, c](auto &&...arg) { (arg.write(b, c), ...); }, m_p);
+		}
 
-			tm time;
-#ifdef __linux__
-			gmtime_r(&t, &time);
-#elif _WIN32
-			gmtime_s(&time, &t);
-#endif // __linux__
-			std::strftime(buf, sizeof buf, "%Y-%m-%d %H:%M:%S ", &time);
+		void _open_buffer_()
+		{
+			std::apply([](auto &&...arg) { (arg.open(), ...); }, m_p);
+		}
 
-			_write_buffer_(std::string_view(buf, sizeof buf), Catagory::INFO);
+		void _close_buffer_()
+		{
+			std::apply([](auto &&...arg) { (arg.close(), ...); }, m_p);
 		}
+	};
 
-		void _write_catagory_(Catagory c)
+	/**
+	 * @brief Logger writing through its policies on a background thread. Callers format their record and push it into a
+	 * bounded lock-free multi producer ring (Vyukov's queue), the background thread drains it in batches. The policies are
+	 * only ever used by the background thread.
+	 */
+	template<Policy... Policies>
+	class AsyncLogger
+	{
+	public:
+		/**
+		 * @brief Behaviour of a write while the ring is full
+		 */
+		enum Overflow
 		{
-			switch (c)
+			BLOCK,		// Wait for the background thread
+			DROP,		// Discard the record
+			DROP_COUNT, // Discard the record and report the amount of dropped records in the log
+		};
+
+		class _Stream_
+		{
+		public:
+			_Stream_(AsyncLogger *log, Catagory c)
+				: m_log(log)
+				, m_catagory(c)
+				, m_time(std::chrono::system_clock::now())
+				, m_begin(_buffer_().size())
 			{
-			case Catagory::INFO: _write_buffer_("[INFO] ", c); break;
-			case Catagory::WARN: _write_buffer_("[WARN] ", c); break;
-			case Catagory::ERR: _write_buffer_("[ERROR] ", c); break;
-			case Catagory::FATAL: _write_buffer_("[FATAL] ", c); break;
-			case Catagory::SUCCESS: _write_buffer_("[SUCCESS] ", c); break;
-			default: break;
+			}
+
+			_Stream_(const _Stream_ &) = delete;
+
+			~_Stream_()
+			{
+				auto &buf = _buffer_();
+				if (m_catagory >= LOG_MIN_SEVERITY)
+					m_log->_push_(m_log->m_overflow, Record::LINE, m_catagory, m_time,
+								  std::string_view(buf).substr(m_begin));
+				buf.resize(m_begin);
+			}
+
+			template<typename T>
+			auto operator<<(const T &v) -> auto &
+			{
+				if (m_catagory >= LOG_MIN_SEVERITY)
+					detail::_append_(_buffer_(), v);
+				return *this;
+			}
+
+		private:
+			AsyncLogger						 *m_log;
+			Catagory							  m_catagory;
+			std::chrono::system_clock::time_point m_time;
+			size_t								  m_begin; // Start of this record, streams nest when logging while logging
+
+			static auto _buffer_() -> std::string &
+			{
+				thread_local std::string buf; // Reused to avoid allocations, records of nested streams follow each other
+				return buf;
+			}
+		};
+
+		/**
+		 * @brief Initialize the logger including it's policies and start the background thread
+		 * @param capacity Amount of records in the ring, rounded up to a power of 2
+		 * @param o Behaviour on a full ring
+		 * @param pols Policy construction
+		 */
+		explicit AsyncLogger(size_t capacity, Overflow o, Policies &&...pols)
+			: m_p(std::forward<Policies>(pols)...)
+			, m_cells(std::make_unique<Cell[]>(std::bit_ceil(std::max<size_t>(capacity, 2))))
+			, m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1)
+			, m_overflow(o)
+		{
+			for (size_t i = 0; i <= m_mask; ++i) m_cells[i].seq.store(i, std::memory_order_relaxed);
+			m_thread = std::jthread([this] { _drain_(); });
+		}
+
+		AsyncLogger(const AsyncLogger &) = delete;
+		AsyncLogger(AsyncLogger &&)		 = delete;
+
+		/**
+		 * @brief Write the remaining records and stop the background thread
+		 */
+		~AsyncLogger()
+		{
+			_push_(BLOCK, Record::STOP, Catagory::INFO, {}, {});
+		}
+
+		/**
+		 * @brief Create a write instance. The record is pushed when it is destroyed.
+		 * @param c Catagory to use
+		 * @return ostream
+		 */
+		auto write(Catagory c) { return _Stream_(this, c); }
+
+		/**
+		 * @brief Write a string to the log
+		 * @param c Catagory to use
+		 * @param val String to write
+		 */
+		void write(Catagory c, std::string_view val)
+		{
+			if (c >= LOG_MIN_SEVERITY)
+				_push_(m_overflow, Record::LINE, c, std::chrono::system_clock::now(), val);
+		}
+
+		/**
+		 * @brief Write a seperation line
+		 */
+		void seperate() { _push_(m_overflow, Record::RAW, Catagory::INFO, {}, "\n----------------------------------------\n\n"); }
+
+		/**
+		 * @brief Wait until every record written before the call went through the policies and the policies with a
+		 * flush() method are flushed
+		 */
+		void flush()
+		{
+			const auto pos = _push_(BLOCK, Record::FLUSH, Catagory::INFO, {}, {});
+			for (auto done = m_done.load(std::memory_order_acquire); done <= pos;
+				 done	   = m_done.load(std::memory_order_acquire))
+				m_done.wait(done, std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Get the amount of dropped records (DROP_COUNT only)
+		 * @return The amount
+		 */
+		[[nodiscard]] auto dropped() const noexcept -> size_t { return m_dropped.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr size_t BATCH = 256; // Records until the policies are flushed
+
+		struct Record
+		{
+			enum Kind : uint8_t
+			{
+				LINE,
+				RAW,
+				FLUSH,
+				STOP,
+			};
+
+			Kind								  kind;
+			Catagory							  catagory;
+			std::chrono::system_clock::time_point time;
+			std::string							  msg; // Keeps its capacity between uses
+		};
+
+		struct alignas(64) Cell
+		{
+			std::atomic<size_t> seq;
+			Record				r;
+		};
+
+		std::tuple<Policies...> m_p;
+
+		std::unique_ptr<Cell[]> m_cells;
+		size_t					m_mask;
+		Overflow				m_overflow;
+
+		alignas(64) std::atomic<size_t> m_tail = 0; // Next position to push to
+		alignas(64) std::atomic<size_t> m_done = 0; // Records written and flushed
+		std::atomic<size_t>				m_dropped = 0;
+
+		std::jthread m_thread;
+
+		/**
+		 * @brief Push a record
+		 * @return position of the record or npos if it was dropped
+		 */
+		auto _push_(Overflow o, typename Record::Kind k, Catagory c, std::chrono::system_clock::time_point t,
+					std::string_view msg) -> size_t
+		{
+			auto pos = m_tail.load(std::memory_order_relaxed);
+			Cell *cell;
+
+			for (;;)
+			{
+				cell			= &m_cells[pos & m_mask];
+				const auto seq	= cell->seq.load(std::memory_order_acquire);
+				const auto diff = ptrdiff_t(seq - pos);
+
+				if (diff == 0 && m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+				if (diff < 0) // Full
+				{
+					if (o == DROP_COUNT)
+						m_dropped.fetch_add(1, std::memory_order_relaxed);
+					if (o != BLOCK)
+						return std::string_view::npos;
+
+					const auto done = m_done.load(std::memory_order_acquire);
+					if (ptrdiff_t(cell->seq.load(std::memory_order_acquire) - pos) < 0)
+						m_done.wait(done, std::memory_order_acquire);
+					pos = m_tail.load(std::memory_order_relaxed);
+				}
+				else if (diff != 0)
+					pos = m_tail.load(std::memory_order_relaxed);
+			}
+
+			cell->r.kind	 = k;
+			cell->r.catagory = c;
+			cell->r.time	 = t;
+			cell->r.msg.assign(msg);
+			cell->seq.store(pos + 1, std::memory_order_release);
+
+			m_tail.notify_one();
+			return pos;
+		}
+
+		void _drain_()
+		{
+			size_t head = 0, batch = 0, reported = 0;
+			TimestampFormatter time;
+
+			auto finish_batch = [&](bool flush) {
+				if (const auto d = m_dropped.load(std::memory_order_relaxed); d != reported)
+				{
+					char buf[64];
+					auto end = std::to_chars(buf, buf + sizeof buf, d - reported).ptr;
+					reported = d;
+
+					_write_line_(Catagory::WARN, "Dropped ", std::string_view(buf, end - buf), " log records.");
+				}
+
+				std::apply([](auto &&...arg) { (arg.close(), ...); }, m_p);
+				if (flush)
+					std::apply([](auto &&...arg) { (_flush_(arg), ...); }, m_p);
+
+				m_done.store(head, std::memory_order_release);
+				m_done.notify_all();
+				batch = 0;
+			};
+
+			for (;;)
+			{
+				auto &cell = m_cells[head & m_mask];
+
+				if (cell.seq.load(std::memory_order_acquire) != head + 1) // Nothing published
+				{
+					if (batch != 0)
+						finish_batch(true); // Idle, so flushing costs nothing
+					else if (const auto tail = m_tail.load(std::memory_order_acquire); tail == head)
+						m_tail.wait(head, std::memory_order_acquire);
+					else
+						std::this_thread::yield(); // Reserved but not written yet
+
+					continue;
+				}
+
+				if (batch++ == 0)
+					std::apply([](auto &&...arg) { (arg.open(), ...); }, m_p);
+
+				const auto kind = cell.r.kind;
+
+				if (kind == Record::FLUSH || kind == Record::STOP)
+				{
+					cell.seq.store(head + m_mask + 1, std::memory_order_release);
+					++head;
+					finish_batch(true);
+
+					if (kind == Record::STOP)
+						return;
+					continue;
+				}
+
+				if (kind == Record::RAW)
+					_write_(cell.r.msg, Catagory::INFO);
+				else
+				{
+					_write_(time.format(cell.r.time), Catagory::INFO);
+					_write_line_(cell.r.catagory, cell.r.msg);
+				}
+
+				cell.r.msg.clear();
+				cell.seq.store(head + m_mask + 1, std::memory_order_release);
+				++head;
+
+				if (batch == BATCH)
+					finish_batch(false);
 			}
 		}
 
 		template<typename T>
-		void _write_buffer_(T &&b, Catagory c)
+		void _write_(const T &b, Catagory c)
 		{
 			std::apply([&b, c](auto &&...arg) { (arg.write(b, c), ...); }, m_p);
 		}
 
-		void _open_buffer_()
+		template<typename P>
+		static void _flush_(P &p)
 		{
-			std::apply([](auto &&...arg) { (arg.open(), ...); }, m_p);
+			if constexpr (requires { p.flush(); })
+				p.flush();
 		}
 
-		void _close_buffer_()
+		template<typename... T>
+		void _write_line_(Catagory c, const T &...msg)
 		{
-			std::apply([](auto &&...arg) { (arg.close(), ...); }, m_p);
+			_write_(detail::_catagory_name_(c), c);
+			(_write_(msg, Catagory::INFO), ...);
+			_write_("\n", Catagory::INFO);
 		}
 	};
 
+#if defined unix || defined __unix || defined __unix__
+	/**
+	 * @brief Policy writing to a file that stays open. Writes are combined in a buffer which is flushed when full, when
+	 * the interval passed at the end of a record or on flush(). Large writes bypass the buffer through writev. The file
+	 * can be rotated to numbered files (name.1 being the newest) by size or age.
+	 */
+	class FilePolicy
+	{
+	public:
+		/**
+		 * @brief Sync after each flush to survive crashes of the system
+		 */
+		enum Durability
+		{
+			NONE, // Leave it to the kernel
+			DATA, // fdatasync
+			FULL, // fsync
+		};
+
+		struct Options
+		{
+			size_t					  buffer	 = 1 << 16;				  // Buffer size
+			std::chrono::milliseconds interval	 = std::chrono::seconds(1); // Flush interval, 0 flushes every record
+			Durability				  durability = NONE;
+			size_t					  max_size	 = 0;	 // Rotate once the file is larger, 0 for never
+			std::chrono::seconds	  max_age	 = {};	 // Rotate once the file is older, 0 for never
+			size_t					  max_files	 = 8;	 // Rotated files to keep
+			bool					  append	 = false; // Append to an existing file instead of truncating it
+		};
+
+		/**
+		 * @brief Create a file policy with the default options
+		 * @param name Name of the file to log to
+		 */
+		explicit FilePolicy(std::string_view name)
+			: FilePolicy(name, Options())
+		{
+		}
+
+		/**
+		 * @brief Create a file policy
+		 * @param name Name of the file to log to
+		 * @param o Buffering and rotation options
+		 */
+		FilePolicy(std::string_view name, Options o)
+			: m_file_name(name)
+			, m_options(o)
+			, m_buf(std::make_unique<char[]>(std::max<size_t>(o.buffer, 1)))
+		{
+			_open_file_(o.append ? O_APPEND : O_TRUNC);
+		}
+
+		FilePolicy(FilePolicy &&o) noexcept
+			: m_file_name(std::move(o.m_file_name))
+			, m_options(o.m_options)
+			, m_buf(std::move(o.m_buf))
+			, m_used(std::exchange(o.m_used, 0))
+			, m_fd(std::exchange(o.m_fd, -1))
+			, m_size(o.m_size)
+			, m_opened(o.m_opened)
+			, m_flushed(o.m_flushed)
+		{
+		}
+
+		FilePolicy(const FilePolicy &) = delete;
+
+		~FilePolicy()
+		{
+			if (m_fd == -1)
+				return;
+
+			try
+			{
+				flush();
+			}
+			catch (...)
+			{
+			}
+			::close(m_fd);
+		}
+
+		/**
+		 * @brief Ignored
+		 */
+		void open() noexcept {}
+		/**
+		 * @brief End of a record. Flushes after the interval and rotates if necessary.
+		 */
+		void close()
+		{
+			if (std::chrono::steady_clock::now() - m_flushed >= m_options.interval)
+				flush();
+			else
+				_rotate_if_();
+		}
+
+		/**
+		 * @brief Write the buffer to the file and sync it according to the durability
+		 */
+		void flush()
+		{
+			_write_all_(nullptr, 0);
+			m_flushed = std::chrono::steady_clock::now();
+
+			if (m_options.durability == DATA)
+				::fdatasync(m_fd);
+			else if (m_options.durability == FULL)
+				::fsync(m_fd);
+
+			_rotate_if_();
+		}
+
+		/**
+		 * @brief Write the log to the buffer
+		 * @param msg Log to write
+		 * @param c Catagory to use (ignored)
+		 */
+		template<typename T>
+		void write(const T &msg, Catagory)
+		{
+			std::string_view str;
+			std::string		 tmp;
+
+			if constexpr (std::is_convertible_v<const T &, std::string_view>)
+				str = msg;
+			else
+			{
+				detail::_append_(tmp, msg);
+				str = tmp;
+			}
+
+			if (str.size() > m_options.buffer - m_used)
+				_write_all_(str.data(), str.size()); // Buffer and message in one call
+			else
+			{
+				std::memcpy(m_buf.get() + m_used, str.data(), str.size());
+				m_used += str.size();
+			}
+		}
+
+		/**
+		 * @brief Get the path of a rotated file
+		 * @param i Number of the file, 0 being the current one
+		 */
+		[[nodiscard]] auto file_name(size_t i = 0) const -> std::string
+		{
+			return i == 0 ? m_file_name : m_file_name + '.' + std::to_string(i);
+		}
+
+	private:
+		std::string				m_file_name;
+		Options					m_options;
+		std::unique_ptr<char[]> m_buf;
+		size_t					m_used = 0;
+		int						m_fd   = -1;
+		size_t					m_size = 0; // Size of the current file
+
+		std::chrono::steady_clock::time_point m_opened;
+		std::chrono::steady_clock::time_point m_flushed;
+
+		void _open_file_(int flags)
+		{
+			m_fd = ::open(m_file_name.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | flags, 0644);
+			if (m_fd == -1)
+				throw std::system_error(errno, std::generic_category(), "Failed to open the log file.");
+
+			struct stat st;
+			m_size	  = ::fstat(m_fd, &st) == 0 ? size_t(st.st_size) : 0;
+			m_opened  = std::chrono::steady_clock::now();
+			m_flushed = m_opened;
+		}
+
+		/**
+		 * @brief Write the buffer followed by extra data
+		 */
+		void _write_all_(const char *extra, size_t n)
+		{
+			iovec iov[2] = { { m_buf.get(), m_used }, { const_cast<char *>(extra), n } };
+
+			for (size_t i = 0; i < 2;)
+			{
+				if (iov[i].iov_len == 0)
+				{
+					++i;
+					continue;
+				}
+
+				const auto res = ::writev(m_fd, iov + i, int(2 - i));
+				if (res == -1)
+				{
+					if (errno == EINTR)
+						continue;
+					throw std::system_error(errno, std::generic_category(), "Failed to write the log file.");
+				}
+
+				m_size += res;
+				for (auto left = size_t(res); left != 0;) // Skip the written part
+				{
+					const auto k	= std::min(left, iov[i].iov_len);
+					iov[i].iov_base = static_cast<char *>(iov[i].iov_base) + k;
+					iov[i].iov_len -= k;
+					left -= k;
+					if (iov[i].iov_len == 0)
+						++i;
+				}
+			}
+
+			m_used = 0;
+		}
+
+		void _rotate_if_()
+		{
+			const bool by_size = m_options.max_size != 0 && m_size + m_used >= m_options.max_size;
+			const bool by_age  = m_options.max_age.count() != 0
+				&& std::chrono::steady_clock::now() - m_opened >= m_options.max_age && m_size + m_used != 0;
+
+			if (!by_size && !by_age)
+				return;
+
+			_write_all_(nullptr, 0);
+			if (m_options.durability != NONE)
+				::fsync(m_fd);
+			::close(m_fd);
+			m_fd = -1;
+
+			if (m_options.max_files == 0)
+				std::remove(m_file_name.c_str());
+			else
+			{
+				std::remove(file_name(m_options.max_files).c_str());
+				for (auto i = m_options.max_files; i > 1; --i)
+					std::rename(file_name(i - 1).c_str(), file_name(i).c_str());
+				std::rename(m_file_name.c_str(), file_name(1).c_str());
+			}
+
+			_open_file_(O_TRUNC);
+		}
+	};
+#else
+	/**
+	 * @brief Policy writing to a file through a stream, used where POSIX files are not available
+	 */
 	class FilePolicy
 	{
 	public:
@@ -186,9 +845,9 @@ namespace utl
 		 * @param name Name of the file to log to
 		 */
 		explicit FilePolicy(std::string_view name)
-			: m_file_name(name.data())
+			: m_file_name(name)
 		{
-			std::ofstream(name.data());
+			std::ofstream { m_file_name };
 		}
 
 		/**
@@ -196,7 +855,7 @@ namespace utl
 		 */
 		void open()
 		{
-			m_out_file.open(m_file_name.data(), std::ios::in | std::ios::out);
+			m_out_file.open(m_file_name, std::ios::in | std::ios::out);
 			m_out_file.seekp(m_true_pos);
 		}
 		/**
@@ -209,15 +868,22 @@ namespace utl
 			m_out_file.close();
 		}
 
+		/**
+		 * @brief Write the rest of the buffer to the file
+		 */
+		void flush() { m_out_file.flush(); }
+
 		/**
 		 * @brief Write the log to the file and reiterate when necessary
 		 * @param msg Log to write
 		 * @param c Catagory to use (ignored)
 		 */
 		template<typename T>
-		void write(const T &msg, Catagory c)
+		void write(const T &msg, Catagory)
 		{
-			m_out_file << msg;
+			std::string tmp;
+			detail::_append_(tmp, msg);
+			m_out_file << tmp;
 
 			if (m_out_file.tellp() >= std::numeric_limits<unsigned int>::max())
 				m_out_file.seekp(0, std::ios::beg);
@@ -228,6 +894,7 @@ namespace utl
 		std::ofstream			m_out_file;
 		std::ofstream::pos_type m_true_pos = 0;
 	};
+#endif
 
 	class ConsolePolicy
 	{
@@ -1,17 +1,50 @@
 #if not defined _UTILLIB_FILESYSTEM_
 #define _UTILLIB_FILESYSTEM_
 
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <cerrno>
+#include <cstdint>
+
 #if defined unix || defined __unix || defined __unix__
 #include <unistd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <pwd.h>
 #elif defined _WIN32
 #include <Shlobj.h>
 #endif
 
+#if defined __linux__
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+#include "Scheduler.h"
+#endif
+
 namespace utl
 {
-	auto home_dir() noexcept -> const char *
+	inline auto home_dir() noexcept -> const char *
 	{
 		const char *res = nullptr;
 
@@ -25,6 +58,936 @@ namespace utl
 
 		return res;
 	}
+
+#if defined unix || defined __unix || defined __unix__
+	/**
+	 * @brief Read only memory mapping of a whole file. Converts to a string view so it can be handed to a parser without
+	 * copying the file. Empty files aren't mapped and give an empty view.
+	 */
+	class MappedFile
+	{
+	public:
+		/**
+		 * @brief Hints given to the kernel about the access pattern. Can be combined.
+		 */
+		enum Advice : unsigned
+		{
+			NORMAL	   = 0,
+			SEQUENTIAL = 1 << 0, // Aggressive read ahead, pages dropped after use
+			WILLNEED   = 1 << 1, // Start reading the whole file in the background
+			RANDOM	   = 1 << 2, // Disable read ahead
+			HUGEPAGE   = 1 << 3, // Align the mapping to huge pages and ask for them (needs file THP support)
+		};
+
+		MappedFile() = default;
+
+		/**
+		 * @brief Map a file
+		 * @param path Path to the file
+		 * @param advice Combination of Advice flags
+		 */
+		explicit MappedFile(const char *path, unsigned advice = SEQUENTIAL)
+		{
+			const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd == -1)
+				throw std::system_error(errno, std::generic_category(), "Failed to open file to map.");
+
+			struct stat st;
+			if (fstat(fd, &st) == -1)
+			{
+				const auto err = errno;
+				::close(fd);
+				throw std::system_error(err, std::generic_category(), "Failed to query file to map.");
+			}
+
+			m_size = st.st_size;
+
+			if (m_size != 0)
+			{
+				m_data = (advice & HUGEPAGE) ? _map_aligned_(fd) : mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+				if (m_data == MAP_FAILED)
+				{
+					const auto err = errno;
+					::close(fd);
+					m_data = nullptr;
+					throw std::system_error(err, std::generic_category(), "Failed to map file.");
+				}
+
+				_advise_(advice);
+			}
+
+			::close(fd); // Mapping stays valid
+		}
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile(MappedFile &&o) noexcept
+			: m_data(std::exchange(o.m_data, nullptr))
+			, m_size(std::exchange(o.m_size, 0))
+		{
+		}
+
+		auto operator=(const MappedFile &) -> MappedFile & = delete;
+		auto operator=(MappedFile &&o) noexcept -> MappedFile &
+		{
+			std::swap(m_data, o.m_data);
+			std::swap(m_size, o.m_size);
+			return *this;
+		}
+
+		~MappedFile()
+		{
+			if (m_data != nullptr)
+				munmap(m_data, m_size);
+		}
+
+		/**
+		 * @brief Get the mapped bytes
+		 * @return ptr to the bytes or nullptr on empty files
+		 */
+		[[nodiscard]] auto data() const noexcept -> const char * { return static_cast<const char *>(m_data); }
+
+		/**
+		 * @brief Get the file size
+		 * @return The size
+		 */
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_size; }
+
+		/**
+		 * @brief Check if file is empty
+		 * @return true Nothing is mapped
+		 * @return false File has content
+		 */
+		[[nodiscard]] auto empty() const noexcept -> bool { return m_size == 0; }
+
+		/**
+		 * @brief Get the file as string
+		 * @return The string
+		 */
+		[[nodiscard]] auto view() const noexcept -> std::string_view { return { data(), m_size }; }
+		operator std::string_view() const noexcept { return view(); }
+
+	private:
+		static constexpr size_t HUGE_PAGE = 1U << 21;
+
+		void  *m_data = nullptr;
+		size_t m_size = 0;
+
+		auto _map_aligned_(int fd) const noexcept -> void *
+		{
+			// Reserve enough address space to place the mapping on a huge page boundary
+			const auto reserve = mmap(nullptr, m_size + HUGE_PAGE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (reserve == MAP_FAILED)
+				return MAP_FAILED;
+
+			const auto base	   = reinterpret_cast<uintptr_t>(reserve);
+			const auto aligned = (base + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+			const auto page	   = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			const auto length  = (m_size + page - 1) & ~(page - 1);
+
+			const auto res =
+				mmap(reinterpret_cast<void *>(aligned), m_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+			if (res == MAP_FAILED)
+			{
+				munmap(reserve, m_size + HUGE_PAGE);
+				return MAP_FAILED;
+			}
+
+			// Release the unused reservation around the mapping
+			if (aligned != base)
+				munmap(reserve, aligned - base);
+			if (const auto tail = aligned + length; tail < base + m_size + HUGE_PAGE)
+				munmap(reinterpret_cast<void *>(tail), base + m_size + HUGE_PAGE - tail);
+
+			return res;
+		}
+
+		void _advise_(unsigned advice) const noexcept
+		{
+			// Hints only, failures are ignored
+			if (advice & SEQUENTIAL)
+				madvise(m_data, m_size, MADV_SEQUENTIAL);
+			if (advice & RANDOM)
+				madvise(m_data, m_size, MADV_RANDOM);
+			if (advice & WILLNEED)
+				madvise(m_data, m_size, MADV_WILLNEED);
+#if defined MADV_HUGEPAGE
+			if (advice & HUGEPAGE)
+				madvise(m_data, m_size, MADV_HUGEPAGE);
+#endif
+		}
+	};
+#endif
+
+#if defined __linux__
+	// -----------------------------------------------------------------------------
+	// Directory walking
+	// -----------------------------------------------------------------------------
+
+	enum class EntryType : uint8_t
+	{
+		UNKNOWN,
+		FILE,
+		DIRECTORY,
+		SYMLINK,
+		OTHER,
+	};
+
+	/**
+	 * @brief Entry found by walk_directory. The views are only valid during the callback.
+	 */
+	struct DirEntry
+	{
+		std::string_view	path;  // Root joined with the path below it
+		std::string_view	name;  // Last component of path
+		EntryType			type;  // Symlinks aren't followed
+		uint64_t			inode; // Inode number
+		size_t				depth; // 0 for the entries of the root
+		const struct statx *stat;  // Only set if WalkOptions::stat_mask isn't 0
+	};
+
+	struct WalkOptions
+	{
+		size_t	 threads   = std::thread::hardware_concurrency(); // 1 walks on the calling thread, else on the Scheduler
+		size_t	 max_depth = std::numeric_limits<size_t>::max();	 // Deepest level reported
+		unsigned stat_mask = 0;										 // STATX_* fields to query for every entry
+	};
+
+	namespace detail
+	{
+		struct _DirFd_
+		{
+			int fd;
+
+			explicit _DirFd_(int fd) noexcept
+				: fd(fd)
+			{
+			}
+			_DirFd_(const _DirFd_ &) = delete;
+			~_DirFd_() { ::close(fd); }
+		};
+
+		/**
+		 * @brief Directory to read. Opened relative to the parent, which stays open as long as a child is queued.
+		 */
+		struct _WalkItem_
+		{
+			std::shared_ptr<_DirFd_> parent;
+			std::string				 path;
+			size_t					 name; // Offset of the last component in path
+			size_t					 depth;
+		};
+
+		/**
+		 * @brief State of one walk. Directories are tasks of group when it is set, otherwise they are kept on stack and
+		 * read by the calling thread.
+		 */
+		template<typename Filter, typename F>
+		struct _Walker_
+		{
+			const WalkOptions	   &opt;
+			Filter				   &filter;
+			F					   &f;
+			TaskGroup			   *group = nullptr;
+			std::vector<_WalkItem_> stack = {};
+			std::atomic<size_t>		errors = 0;
+
+			void push(_WalkItem_ &&item)
+			{
+				if (group == nullptr)
+					stack.emplace_back(std::move(item));
+				else
+					group->run([this, item = std::move(item)]() mutable { _walk_dir_(*this, item); });
+			}
+		};
+
+		constexpr auto _entry_type_(unsigned char d_type) noexcept -> EntryType
+		{
+			switch (d_type)
+			{
+			case DT_REG: return EntryType::FILE;
+			case DT_DIR: return EntryType::DIRECTORY;
+			case DT_LNK: return EntryType::SYMLINK;
+			case DT_UNKNOWN: return EntryType::UNKNOWN;
+			default: return EntryType::OTHER;
+			}
+		}
+
+		constexpr auto _entry_type_mode_(unsigned mode) noexcept -> EntryType
+		{
+			switch (mode & S_IFMT)
+			{
+			case S_IFREG: return EntryType::FILE;
+			case S_IFDIR: return EntryType::DIRECTORY;
+			case S_IFLNK: return EntryType::SYMLINK;
+			default: return EntryType::OTHER;
+			}
+		}
+
+		/**
+		 * @brief Read one directory with getdents64, report its entries and queue its subdirectories
+		 */
+		template<typename Filter, typename F>
+		void _walk_dir_(_Walker_<Filter, F> &s, _WalkItem_ &item)
+		{
+			constexpr auto	 FLAGS = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+			constexpr size_t BUF   = 1U << 16;
+
+			const auto fd = item.parent ? ::openat(item.parent->fd, item.path.c_str() + item.name, FLAGS)
+										: ::open(item.path.c_str(), FLAGS & ~O_NOFOLLOW);
+			if (fd == -1)
+			{
+				s.errors.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			const auto dir = std::make_shared<_DirFd_>(fd);
+			item.parent.reset();
+
+			// Per directory since a callback may run other directories of the walk on this thread while it waits
+			const auto	buf = std::make_unique_for_overwrite<uint64_t[]>(BUF / sizeof(uint64_t));
+			std::string path(std::move(item.path));
+			if (path.empty() || path.back() != '/')
+				path += '/';
+			const auto base = path.size();
+
+			// Layout of struct linux_dirent64
+			constexpr size_t RECLEN = 16, TYPE = 18, NAME = 19;
+
+			for (;;)
+			{
+				const auto n = ::syscall(SYS_getdents64, fd, buf.get(), BUF);
+				if (n <= 0)
+				{
+					if (n < 0)
+						s.errors.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+
+				for (long off = 0; off < n;)
+				{
+					const auto *rec = reinterpret_cast<const char *>(buf.get()) + off;
+
+					uint64_t ino;
+					uint16_t reclen;
+					std::memcpy(&ino, rec, sizeof ino);
+					std::memcpy(&reclen, rec + RECLEN, sizeof reclen);
+					off += reclen;
+
+					const std::string_view name(rec + NAME);
+					if (name == "." || name == "..")
+						continue;
+
+					path.resize(base);
+					path += name;
+
+					DirEntry e = { .path  = path,
+								   .name  = std::string_view(path).substr(base),
+								   .type  = _entry_type_(static_cast<unsigned char>(rec[TYPE])),
+								   .inode = ino,
+								   .depth = item.depth,
+								   .stat  = nullptr };
+
+					// Type from the directory entry if the filesystem gives it, stat only as asked or needed
+					struct statx st;
+					if (const auto mask = s.opt.stat_mask | (e.type == EntryType::UNKNOWN ? STATX_TYPE : 0); mask != 0)
+					{
+						if (::statx(fd, e.name.data(), AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT | AT_STATX_DONT_SYNC, mask, &st)
+							== 0)
+						{
+							if (e.type == EntryType::UNKNOWN)
+								e.type = _entry_type_mode_(st.stx_mode);
+							if (s.opt.stat_mask != 0)
+								e.stat = &st;
+						}
+						else
+							s.errors.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					if (!s.filter(std::as_const(e)))
+						continue;
+
+					s.f(std::as_const(e));
+
+					if (e.type == EntryType::DIRECTORY && item.depth < s.opt.max_depth)
+						s.push({ .parent = dir, .path = path, .name = base, .depth = item.depth + 1 });
+				}
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Walk a directory tree on the shared Scheduler. Every directory is a task, read with getdents64 and opened
+	 * relative to its parent, so idle workers steal directories from the others. Symlinks are reported but not
+	 * followed.
+	 *
+	 * @param root Directory to walk, isn't reported itself
+	 * @param opt Threads, depth and stat fields to query
+	 * @param filter Predicate taking a DirEntry, rejected entries aren't reported and not descended into
+	 * @param f Callback taking each DirEntry, called concurrently from all threads
+	 * @return Amount of directories and entries that couldn't be read
+	 */
+	template<typename Filter, typename F>
+	auto walk_directory(std::string_view root, const WalkOptions &opt, Filter &&filter, F &&f) -> size_t
+	{
+		const std::string path(root);
+		struct stat		  st;
+		if (::stat(path.c_str(), &st) == -1)
+			throw std::system_error(errno, std::generic_category(), "Failed to open directory to walk.");
+		if (!S_ISDIR(st.st_mode))
+			throw std::system_error(ENOTDIR, std::generic_category(), "Failed to open directory to walk.");
+
+		detail::_Walker_<Filter, F> s { .opt = opt, .filter = filter, .f = f };
+
+		if (opt.threads <= 1)
+		{
+			s.push({ .parent = nullptr, .path = path, .name = 0, .depth = 0 });
+			while (!s.stack.empty())
+			{
+				auto item = std::move(s.stack.back());
+				s.stack.pop_back();
+				detail::_walk_dir_(s, item);
+			}
+		}
+		else
+		{
+			TaskGroup g;
+			s.group = &g;
+			s.push({ .parent = nullptr, .path = path, .name = 0, .depth = 0 });
+			g.wait();
+		}
+
+		return s.errors.load();
+	}
+
+	/**
+	 * @brief Walk a whole directory tree in parallel, see walk_directory above
+	 *
+	 * @param root Directory to walk
+	 * @param opt Threads, depth and stat fields to query
+	 * @param f Callback taking each DirEntry, called concurrently from all threads
+	 * @return Amount of directories and entries that couldn't be read
+	 */
+	template<typename F>
+	auto walk_directory(std::string_view root, const WalkOptions &opt, F &&f) -> size_t
+	{
+		return walk_directory(
+			root, opt, [](const DirEntry &) { return true; }, std::forward<F>(f));
+	}
+
+	// -----------------------------------------------------------------------------
+	// Bulk reading
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief File read by FileReader
+	 */
+	struct FileRead
+	{
+		size_t			 index; // Position in the list of paths
+		std::string_view path;
+		std::string_view data;	// Content, only valid during the callback
+		int				 error; // errno of the failed open or read, 0 on success
+	};
+
+	struct ReaderOptions
+	{
+		unsigned queue_depth = 64;								 // Files read at once by io_uring
+		size_t	 buffer_size = size_t(128) << 10;				 // Registered buffer per queue slot
+		size_t	 threads	 = std::thread::hardware_concurrency(); // Threads of the pread fallback
+		bool	 io_uring	 = true;								 // Use io_uring if the kernel supports it
+	};
+
+	namespace detail
+	{
+#if __has_include(<linux/io_uring.h>)
+		/**
+		 * @brief Minimal io_uring over the raw syscalls. Submissions are only made by the owner, so the ring indices
+		 * shared with the kernel are the only synchronization.
+		 */
+		class _IoUring_
+		{
+		public:
+			explicit _IoUring_(unsigned entries)
+			{
+				io_uring_params p = {};
+				m_fd			  = int(::syscall(__NR_io_uring_setup, entries, &p));
+				if (m_fd == -1)
+					throw std::system_error(errno, std::generic_category(), "Failed to setup io_uring.");
+
+				m_sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+				m_cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+				if (p.features & IORING_FEAT_SINGLE_MMAP)
+					m_sq_size = m_cq_size = std::max(m_sq_size, m_cq_size);
+				m_sqe_size = p.sq_entries * sizeof(io_uring_sqe);
+
+				m_sq = _map_(m_sq_size, IORING_OFF_SQ_RING);
+				m_cq = (p.features & IORING_FEAT_SINGLE_MMAP) ? m_sq : _map_(m_cq_size, IORING_OFF_CQ_RING);
+				m_sqes = static_cast<io_uring_sqe *>(_map_(m_sqe_size, IORING_OFF_SQES));
+				if (m_sq == MAP_FAILED || m_cq == MAP_FAILED || m_sqes == MAP_FAILED)
+				{
+					const auto err = errno;
+					_unmap_();
+					throw std::system_error(err, std::generic_category(), "Failed to map io_uring.");
+				}
+
+				m_sq_tail  = _at_(m_sq, p.sq_off.tail);
+				m_sq_mask  = *_at_(m_sq, p.sq_off.ring_mask);
+				m_sq_array = _at_(m_sq, p.sq_off.array);
+				m_cq_head  = _at_(m_cq, p.cq_off.head);
+				m_cq_tail  = _at_(m_cq, p.cq_off.tail);
+				m_cq_mask  = *_at_(m_cq, p.cq_off.ring_mask);
+				m_cqes	   = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(m_cq) + p.cq_off.cqes);
+			}
+
+			_IoUring_(const _IoUring_ &) = delete;
+
+			~_IoUring_() { _unmap_(); }
+
+			/**
+			 * @brief Check if the kernel knows the operations
+			 */
+			[[nodiscard]] auto supports(std::initializer_list<unsigned> ops) const -> bool
+			{
+				constexpr unsigned OPS = 256;
+
+				const auto buf	 = std::make_unique<char[]>(sizeof(io_uring_probe) + OPS * sizeof(io_uring_probe_op));
+				auto	  *probe = reinterpret_cast<io_uring_probe *>(buf.get());
+				if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_PROBE, probe, OPS) == -1)
+					return false;
+
+				return std::all_of(ops.begin(), ops.end(), [probe](unsigned op) {
+					return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+				});
+			}
+
+			/**
+			 * @brief Pin buffers for IORING_OP_READ_FIXED
+			 * @return Success
+			 */
+			auto register_buffers(const iovec *v, unsigned n) noexcept -> bool
+			{
+				return ::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, v, n) == 0;
+			}
+
+			/**
+			 * @brief Queue a submission, the ring must have been created large enough
+			 */
+			void push(const io_uring_sqe &sqe) noexcept
+			{
+				const auto tail = *m_sq_tail;
+				const auto i	= tail & m_sq_mask;
+
+				m_sqes[i]	  = sqe;
+				m_sq_array[i] = i;
+				std::atomic_ref(*m_sq_tail).store(tail + 1, std::memory_order_release);
+				++m_unsubmitted;
+			}
+
+			/**
+			 * @brief Submit the queued submissions and wait for at least one completion
+			 */
+			void submit_and_wait()
+			{
+				for (;;)
+				{
+					const auto res = ::syscall(__NR_io_uring_enter, m_fd, m_unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+					if (res >= 0)
+					{
+						m_unsubmitted -= unsigned(res);
+						return;
+					}
+					if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+						throw std::system_error(errno, std::generic_category(), "Failed to submit to io_uring.");
+				}
+			}
+
+			/**
+			 * @brief Hand every available completion to f
+			 */
+			template<typename F>
+			void completions(F &&f)
+			{
+				auto	   head = *m_cq_head;
+				const auto tail = std::atomic_ref(*m_cq_tail).load(std::memory_order_acquire);
+
+				for (; head != tail; ++head)
+				{
+					const auto cqe = m_cqes[head & m_cq_mask];
+					std::atomic_ref(*m_cq_head).store(head + 1, std::memory_order_release);
+					f(cqe);
+				}
+			}
+
+		private:
+			int			  m_fd;
+			void		 *m_sq	 = MAP_FAILED;
+			void		 *m_cq	 = MAP_FAILED;
+			io_uring_sqe *m_sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+			size_t		  m_sq_size, m_cq_size, m_sqe_size;
+
+			unsigned	 *m_sq_tail, *m_sq_array, *m_cq_head, *m_cq_tail;
+			unsigned	  m_sq_mask, m_cq_mask;
+			io_uring_cqe *m_cqes;
+			unsigned	  m_unsubmitted = 0;
+
+			auto _map_(size_t size, off_t off) const noexcept -> void *
+			{
+				return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, off);
+			}
+
+			static auto _at_(void *base, unsigned off) noexcept -> unsigned *
+			{
+				return reinterpret_cast<unsigned *>(static_cast<char *>(base) + off);
+			}
+
+			void _unmap_() noexcept
+			{
+				if (m_sqes != MAP_FAILED)
+					::munmap(m_sqes, m_sqe_size);
+				if (m_cq != MAP_FAILED && m_cq != m_sq)
+					::munmap(m_cq, m_cq_size);
+				if (m_sq != MAP_FAILED)
+					::munmap(m_sq, m_sq_size);
+				::close(m_fd);
+			}
+		};
+#endif
+
+		/**
+		 * @brief Read a whole file with pread into a growing buffer
+		 * @return errno or 0
+		 */
+		inline auto _read_file_(const char *path, std::unique_ptr<char[]> &buf, size_t &cap, size_t &size) noexcept -> int
+		{
+			size = 0;
+
+			const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (fd == -1)
+				return errno;
+
+			struct stat st;
+			if (::fstat(fd, &st) == -1)
+			{
+				const auto err = errno;
+				::close(fd);
+				return err;
+			}
+
+			if (size_t(st.st_size) > cap)
+			{
+				cap = size_t(st.st_size);
+				buf.reset(new (std::nothrow) char[cap]);
+				if (!buf)
+				{
+					cap = 0;
+					::close(fd);
+					return ENOMEM;
+				}
+			}
+
+			while (size < size_t(st.st_size))
+			{
+				const auto n = ::pread(fd, buf.get() + size, size_t(st.st_size) - size, off_t(size));
+				if (n == 0)
+					break; // Truncated meanwhile
+				if (n == -1)
+				{
+					if (errno == EINTR)
+						continue;
+
+					const auto err = errno;
+					::close(fd);
+					return err;
+				}
+				size += size_t(n);
+			}
+
+			::close(fd);
+			return 0;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Reads many whole files at once. Uses io_uring with a registered buffer per queue slot, larger files get a
+	 * buffer of their own. Without io_uring a thread pool reads the files with pread. Keep the reader to reuse the ring
+	 * and buffers.
+	 */
+	class FileReader
+	{
+	public:
+		/**
+		 * @brief Create the reader, falls back to the thread pool if io_uring can't be setup
+		 * @param opt Queue depth, buffer sizes and threads
+		 */
+		explicit FileReader(const ReaderOptions &opt = {})
+			: m_opt(opt)
+		{
+			m_opt.queue_depth = std::max(m_opt.queue_depth, 1U);
+			m_opt.threads	  = std::max<size_t>(m_opt.threads, 1);
+
+#if __has_include(<linux/io_uring.h>)
+			if (!m_opt.io_uring)
+				return;
+
+			try
+			{
+				m_ring.emplace(m_opt.queue_depth);
+				if (!m_ring->supports({ IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED }))
+				{
+					m_ring.reset();
+					return;
+				}
+			}
+			catch (const std::system_error &)
+			{
+				m_ring.reset();
+				return;
+			}
+
+			m_buffers.reset(new char[m_opt.queue_depth * m_opt.buffer_size]);
+			m_slots.resize(m_opt.queue_depth);
+
+			std::vector<iovec> v(m_opt.queue_depth);
+			for (size_t i = 0; i < v.size(); ++i) v[i] = { m_buffers.get() + i * m_opt.buffer_size, m_opt.buffer_size };
+			m_registered = m_opt.buffer_size != 0 && m_ring->register_buffers(v.data(), unsigned(v.size()));
+#endif
+		}
+
+		/**
+		 * @brief Check if io_uring or the thread pool is used
+		 */
+		[[nodiscard]] auto uses_io_uring() const noexcept -> bool
+		{
+#if __has_include(<linux/io_uring.h>)
+			return m_ring.has_value();
+#else
+			return false;
+#endif
+		}
+
+		/**
+		 * @brief Read files in any order
+		 *
+		 * @param paths Range of paths convertible to std::string_view
+		 * @param f Callback taking a FileRead for every path. Called concurrently by the thread pool.
+		 */
+		template<typename Range, typename F>
+		void read(const Range &paths, F &&f)
+		{
+#if __has_include(<linux/io_uring.h>)
+			if (m_ring)
+				return _read_ring_(paths, f);
+#endif
+			_read_pool_(paths, f);
+		}
+
+	private:
+		ReaderOptions m_opt;
+
+#if __has_include(<linux/io_uring.h>)
+		struct _Slot_
+		{
+			size_t					index;
+			std::string				path; // Kept for the open in flight
+			int						fd = -1;
+			size_t					size;
+			size_t					done;
+			char				   *buf;
+			std::unique_ptr<char[]> large; // For files over the buffer size
+			size_t					large_cap = 0;
+		};
+
+		std::optional<detail::_IoUring_> m_ring;
+		std::unique_ptr<char[]>			 m_buffers;
+		std::vector<_Slot_>				 m_slots;
+		bool							 m_registered = false;
+
+		template<typename Range, typename F>
+		void _read_ring_(const Range &paths, F &f)
+		{
+			auto	   iter	  = std::begin(paths);
+			const auto end	  = std::end(paths);
+			size_t	   next	  = 0;
+			size_t	   active = 0;
+
+			std::exception_ptr ex;
+
+			// The slot is the user data, the low bit tells open from read
+			auto open = [&](size_t s) {
+				io_uring_sqe sqe = {};
+				sqe.opcode		 = IORING_OP_OPENAT;
+				sqe.fd			 = AT_FDCWD;
+				sqe.addr		 = reinterpret_cast<uintptr_t>(m_slots[s].path.c_str());
+				sqe.open_flags	 = O_RDONLY | O_CLOEXEC;
+				sqe.user_data	 = s << 1;
+				m_ring->push(sqe);
+			};
+
+			auto start = [&](size_t s) {
+				m_slots[s].index = next++;
+				m_slots[s].path.assign(std::string_view(*iter++));
+				open(s);
+				++active;
+			};
+
+			auto read = [&](size_t s) {
+				auto &slot = m_slots[s];
+				const auto fixed = m_registered && slot.buf != slot.large.get();
+
+				io_uring_sqe sqe = {};
+				sqe.opcode		 = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+				sqe.fd			 = slot.fd;
+				sqe.addr		 = reinterpret_cast<uintptr_t>(slot.buf + slot.done);
+				sqe.len			 = unsigned(std::min<size_t>(slot.size - slot.done, 1U << 30));
+				sqe.off			 = slot.done;
+				sqe.buf_index	 = fixed ? uint16_t(s) : 0;
+				sqe.user_data	 = (s << 1) | 1;
+				m_ring->push(sqe);
+			};
+
+			// Hand the file over and reuse the slot for the next path
+			auto finish = [&](size_t s, int error) {
+				auto &slot = m_slots[s];
+				if (slot.fd != -1)
+					::close(std::exchange(slot.fd, -1));
+
+				if (!ex)
+					try
+					{
+						f(FileRead { .index = slot.index,
+									 .path	= slot.path,
+									 .data	= error == 0 ? std::string_view(slot.buf, slot.done) : std::string_view(),
+									 .error = error });
+					}
+					catch (...)
+					{
+						ex = std::current_exception();
+					}
+
+				--active;
+				if (!ex && iter != end)
+					start(s);
+			};
+
+			for (size_t s = 0; s < m_slots.size() && iter != end; ++s) start(s);
+
+			while (active != 0)
+			{
+				m_ring->submit_and_wait();
+				m_ring->completions([&](const io_uring_cqe &cqe) {
+					const auto s	= size_t(cqe.user_data >> 1);
+					auto	  &slot = m_slots[s];
+
+					if (cqe.res < 0)
+					{
+						if (cqe.res == -EAGAIN || cqe.res == -EINTR)
+							return (cqe.user_data & 1) ? read(s) : open(s);
+						return finish(s, -cqe.res);
+					}
+
+					if ((cqe.user_data & 1) == 0)
+					{
+						slot.fd = cqe.res;
+
+						struct stat st;
+						if (::fstat(slot.fd, &st) == -1)
+							return finish(s, errno);
+
+						slot.size = size_t(st.st_size);
+						slot.done = 0;
+						slot.buf  = m_buffers.get() + s * m_opt.buffer_size;
+						if (slot.size > m_opt.buffer_size)
+						{
+							if (slot.size > slot.large_cap)
+							{
+								slot.large.reset(new (std::nothrow) char[slot.size]);
+								slot.large_cap = slot.large ? slot.size : 0;
+								if (!slot.large)
+									return finish(s, ENOMEM);
+							}
+							slot.buf = slot.large.get();
+						}
+
+						return slot.size == 0 ? finish(s, 0) : read(s);
+					}
+
+					slot.done += size_t(cqe.res);
+					if (cqe.res == 0 || slot.done == slot.size) // Zero if truncated meanwhile
+						return finish(s, 0);
+					read(s);
+				});
+			}
+
+			if (ex)
+				std::rethrow_exception(ex);
+		}
+#endif
+
+		/**
+		 * @brief Read with pread on own threads rather than the Scheduler, whose workers would block on the disk
+		 */
+		template<typename Range, typename F>
+		void _read_pool_(const Range &paths, F &f)
+		{
+			std::vector<std::string_view> list;
+			for (const auto &p : paths) list.emplace_back(p);
+
+			std::atomic<size_t> next = 0;
+			std::mutex			mutex;
+			std::exception_ptr	ex;
+
+			auto work = [&] {
+				std::unique_ptr<char[]> buf;
+				std::string				path;
+				size_t					cap = 0, size = 0;
+
+				for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < list.size();)
+				{
+					path.assign(list[i]);
+					const auto err = detail::_read_file_(path.c_str(), buf, cap, size);
+
+					try
+					{
+						f(FileRead { .index = i,
+									 .path	= list[i],
+									 .data	= err == 0 ? std::string_view(buf.get(), size) : std::string_view(),
+									 .error = err });
+					}
+					catch (...)
+					{
+						std::scoped_lock l(mutex);
+						if (!ex)
+							ex = std::current_exception();
+						next.store(list.size(), std::memory_order_relaxed);
+					}
+				}
+			};
+
+			{
+				std::vector<std::jthread> pool;
+				for (size_t i = 1; i < std::min(m_opt.threads, list.size()); ++i) pool.emplace_back(work);
+				work();
+			}
+
+			if (ex)
+				std::rethrow_exception(ex);
+		}
+	};
+
+	/**
+	 * @brief Read many whole files at once with a temporary FileReader
+	 *
+	 * @param paths Range of paths convertible to std::string_view
+	 * @param f Callback taking a FileRead for every path
+	 * @param opt Queue depth, buffer sizes and threads
+	 */
+	template<typename Range, typename F>
+	void read_files(const Range &paths, F &&f, const ReaderOptions &opt = {})
+	{
+		FileReader(opt).read(paths, f);
+	}
+#endif
 } // namespace utl
 
 #endif
\ No newline at end of file
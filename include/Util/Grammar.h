@@ -0,0 +1,447 @@
+#if not defined _UTILLIB_GRAMMAR_
+#define _UTILLIB_GRAMMAR_
+
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "Parse.h"
+
+namespace utl::grammar
+{
+	// -----------------------------------------------------------------------------
+	// Element Concept
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Value of elements that only consume input. Left out of sequence results.
+	 */
+	struct Skip
+	{
+	};
+
+	/**
+	 * @brief Grammar element parsing from [it, end), moving it past the consumed input on success
+	 */
+	template<typename T>
+	concept element = requires(const T &t, const char *&it, const char *end, typename T::value_type &v)
+	{
+		{
+			t.parse(it, end, v)
+			} -> std::same_as<bool>;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Terminals
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Match an exact string
+	 */
+	struct Literal
+	{
+		using value_type = Skip;
+
+		std::string_view str;
+
+		constexpr auto parse(const char *&it, const char *end, Skip &) const noexcept -> bool
+		{
+			if (size_t(end - it) < str.size() || std::string_view(it, str.size()) != str)
+				return false;
+
+			it += str.size();
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Skip any amount of whitespace. Including '\n', '\t', ' '.
+	 */
+	struct Space
+	{
+		using value_type = Skip;
+
+		constexpr auto parse(const char *&it, const char *end, Skip &) const noexcept -> bool
+		{
+			const auto loc = find_first_not_of({ it, size_t(end - it) }, SequentialParser::WHITESPACE_SET);
+			it			   = loc == std::string_view::npos ? end : it + loc;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Read a number in place, see SequentialParser::get
+	 */
+	template<typename T>
+	requires(std::integral<T> && !std::same_as<T, bool>) || std::floating_point<T>
+	struct Number
+	{
+		using value_type = T;
+
+		constexpr auto parse(const char *&it, const char *end, T &v) const noexcept -> bool
+		{
+			const char *p;
+
+			if constexpr (std::floating_point<T>)
+			{
+				const auto res = std::from_chars(it, end, v);
+				p			   = res.ec == std::errc() ? res.ptr : nullptr;
+			}
+			else
+				p = detail::_parse_int_(it, end, v);
+
+			if (p == nullptr)
+				return false;
+
+			it = p;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Get the string until one of the delimiters. The delimiter isn't consumed.
+	 */
+	struct Until
+	{
+		using value_type = std::string_view;
+
+		CharSet delims;
+
+		constexpr auto parse(const char *&it, const char *end, std::string_view &v) const noexcept -> bool
+		{
+			const auto loc = find_first_of({ it, size_t(end - it) }, delims);
+			if (loc == std::string_view::npos)
+				return false;
+
+			v = { it, loc };
+			it += loc;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Get a non empty string until whitespace or the end
+	 */
+	struct Word
+	{
+		using value_type = std::string_view;
+
+		constexpr auto parse(const char *&it, const char *end, std::string_view &v) const noexcept -> bool
+		{
+			auto loc = find_first_of({ it, size_t(end - it) }, SequentialParser::WHITESPACE_SET);
+			if (loc == std::string_view::npos)
+				loc = end - it;
+			if (loc == 0)
+				return false;
+
+			v = { it, loc };
+			it += loc;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Match the longest of the keywords, giving its index
+	 */
+	template<const auto &keywords>
+	struct OneOf
+	{
+		using value_type = size_t;
+
+		constexpr auto parse(const char *&it, const char *end, size_t &v) const noexcept -> bool
+		{
+			const auto res = KeywordMatcher<keywords>().match({ it, size_t(end - it) });
+			if (!res)
+				return false;
+
+			v = *res;
+			it += std::string_view(keywords[*res]).size();
+			return true;
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Combinators
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		template<typename T>
+		struct _wrap_
+		{
+			using type = std::tuple<T>;
+		};
+
+		template<>
+		struct _wrap_<Skip>
+		{
+			using type = std::tuple<>;
+		};
+
+		template<typename T>
+		constexpr auto _keep_(T &&v)
+		{
+			if constexpr (std::is_same_v<std::remove_cvref_t<T>, Skip>)
+				return std::tuple<>();
+			else
+				return std::tuple<std::remove_cvref_t<T>>(std::forward<T>(v));
+		}
+
+		template<typename T, typename... U>
+		constexpr bool _all_same_ = (std::is_same_v<T, U> && ...);
+	} // namespace detail
+
+	/**
+	 * @brief Match all elements one after another. Results of non skipping elements are collected in a tuple.
+	 */
+	template<element... E>
+	struct Seq
+	{
+		using value_type = decltype(std::tuple_cat(std::declval<typename detail::_wrap_<typename E::value_type>::type>()...));
+
+		std::tuple<E...> elems;
+
+		constexpr auto parse(const char *&it, const char *end, value_type &v) const -> bool
+		{
+			return _parse_(it, end, v, std::index_sequence_for<E...>());
+		}
+
+	private:
+		template<size_t... I>
+		constexpr auto _parse_(const char *&it, const char *end, value_type &v, std::index_sequence<I...>) const
+			-> bool
+		{
+			std::tuple<typename E::value_type...> vals;
+			auto								  p = it;
+
+			if (!(std::get<I>(elems).parse(p, end, std::get<I>(vals)) && ...))
+				return false;
+
+			v  = std::apply([](auto &&...x) { return std::tuple_cat(detail::_keep_(std::move(x))...); }, std::move(vals));
+			it = p;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Match the first fitting element. Gives the shared result type or a variant holding the index of the match.
+	 */
+	template<element... E>
+	struct Alt
+	{
+		using value_type = std::conditional_t<detail::_all_same_<typename E::value_type...>,
+											  std::tuple_element_t<0, std::tuple<typename E::value_type...>>,
+											  std::variant<typename E::value_type...>>;
+
+		std::tuple<E...> elems;
+
+		constexpr auto parse(const char *&it, const char *end, value_type &v) const -> bool
+		{
+			return _parse_(it, end, v, std::index_sequence_for<E...>());
+		}
+
+	private:
+		template<size_t... I>
+		constexpr auto _parse_(const char *&it, const char *end, value_type &v, std::index_sequence<I...>) const
+			-> bool
+		{
+			return (_try_<I>(it, end, v) || ...);
+		}
+
+		template<size_t I>
+		constexpr auto _try_(const char *&it, const char *end, value_type &v) const -> bool
+		{
+			using T = typename std::tuple_element_t<I, std::tuple<E...>>::value_type;
+
+			T	 res{};
+			auto p = it;
+			if (!std::get<I>(elems).parse(p, end, res))
+				return false;
+
+			if constexpr (std::is_same_v<value_type, T>)
+				v = std::move(res);
+			else
+				v.template emplace<I>(std::move(res));
+
+			it = p;
+			return true;
+		}
+	};
+
+	/**
+	 * @brief Match an element as often as possible, optionally separated. Gives a vector or the count for skipping
+	 * elements.
+	 */
+	template<element E, element S = Literal>
+	struct Repeat
+	{
+		using value_type = std::conditional_t<std::is_same_v<typename E::value_type, Skip>, size_t,
+											  std::vector<typename E::value_type>>;
+
+		E	   elem;
+		S	   sep;
+		size_t min = 0;
+
+		constexpr auto parse(const char *&it, const char *end, value_type &v) const -> bool
+		{
+			size_t n = 0;
+
+			for (auto p = it;;)
+			{
+				typename S::value_type s{};
+				typename E::value_type e{};
+
+				if ((n != 0 && !sep.parse(p, end, s)) || !elem.parse(p, end, e))
+					break;
+
+				if constexpr (std::is_same_v<typename E::value_type, Skip>)
+					++v;
+				else
+					v.emplace_back(std::move(e));
+				++n;
+
+				if (p == it) // Nothing consumed, it would match forever
+					break;
+				it = p;
+			}
+
+			return n >= min;
+		}
+	};
+
+	/**
+	 * @brief Match an element or nothing
+	 */
+	template<element E>
+	struct Opt
+	{
+		using value_type = std::conditional_t<std::is_same_v<typename E::value_type, Skip>, bool,
+											  std::optional<typename E::value_type>>;
+
+		E elem;
+
+		constexpr auto parse(const char *&it, const char *end, value_type &v) const -> bool
+		{
+			typename E::value_type res{};
+			if (elem.parse(it, end, res))
+			{
+				if constexpr (std::is_same_v<typename E::value_type, Skip>)
+					v = true;
+				else
+					v = std::move(res);
+			}
+
+			return true;
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Construction
+	// -----------------------------------------------------------------------------
+
+	inline constexpr Space ws{};
+	inline constexpr Word  word{};
+
+	template<typename T>
+	inline constexpr Number<T> number{};
+
+	template<const auto &keywords>
+	inline constexpr OneOf<keywords> one_of{};
+
+	constexpr auto lit(std::string_view str) noexcept { return Literal{ str }; }
+	constexpr auto until(char delim) noexcept { return Until{ CharSet(std::string_view(&delim, 1)) }; }
+	constexpr auto until(std::string_view delims) noexcept { return Until{ CharSet(delims) }; }
+
+	template<element... E>
+	constexpr auto seq(E... e) noexcept
+	{
+		return Seq<E...>{ { e... } };
+	}
+
+	template<element... E>
+	constexpr auto alt(E... e) noexcept
+	{
+		return Alt<E...>{ { e... } };
+	}
+
+	template<element E>
+	constexpr auto repeat(E e, size_t min = 0) noexcept
+	{
+		return Repeat<E>{ e, {}, min };
+	}
+
+	template<element E, element S>
+	constexpr auto repeat(E e, S sep, size_t min = 0) noexcept
+	{
+		return Repeat<E, S>{ e, sep, min };
+	}
+
+	template<element E>
+	constexpr auto opt(E e) noexcept
+	{
+		return Opt<E>{ e };
+	}
+
+	namespace detail
+	{
+		template<typename T>
+		constexpr bool _is_seq_ = false;
+
+		template<typename... E>
+		constexpr bool _is_seq_<Seq<E...>> = true;
+	} // namespace detail
+
+	/**
+	 * @brief Sequence operator, flattening nested sequences
+	 */
+	template<element A, element B>
+	constexpr auto operator>>(A a, B b) noexcept
+	{
+		if constexpr (detail::_is_seq_<A>)
+			return std::apply([b](auto... e) { return seq(e..., b); }, a.elems);
+		else
+			return seq(a, b);
+	}
+
+	/**
+	 * @brief Alternative operator
+	 */
+	template<element A, element B>
+	constexpr auto operator|(A a, B b) noexcept
+	{
+		return alt(a, b);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Parsing
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Run a grammar at the current position of a parser. The whole grammar is inlined into one routine working
+	 * on a single pointer.
+	 *
+	 * @param g Grammar to match
+	 * @param p Parser to read from. Moves past the match on success only
+	 * @return result or null object if the grammar doesn't match
+	 */
+	template<element G>
+	constexpr auto parse(const G &g, SequentialParser &p) -> std::optional<typename G::value_type>
+	{
+		const auto rest = p.rest();
+		auto	   it	= rest.data();
+
+		typename G::value_type res{};
+		if (!g.parse(it, rest.data() + rest.size(), res))
+			return std::nullopt;
+
+		p.skip_for(it - rest.data());
+		return res;
+	}
+
+} // namespace utl::grammar
+
+#endif
@@ -5,7 +5,18 @@
 #include <queue>
 #include <tuple>
 #include <iostream>
-
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+
+#include "Profile.h"
+#include "Scheduler.h"
 #include "Traits.h"
 
 namespace utl
@@ -37,10 +48,198 @@ namespace utl
 		size_t	 size;	// Size of graph
 	};
 
+	// -----------------------------------------------------------------------------
+	// Memory
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Monotonic memory resource for queries. Allocation moves a pointer, deallocation does nothing and reset
+	 * rewinds everything. Memory is kept over resets, after the largest query no more memory is requested upstream.
+	 */
+	class ArenaResource : public std::pmr::memory_resource
+	{
+	public:
+		/**
+		 * @brief Create the arena
+		 * @param upstream Resource of the blocks
+		 * @param block Size of the first block
+		 */
+		explicit ArenaResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource(),
+							   size_t					  block	   = size_t(64) << 10)
+			: m_upstream(upstream)
+			, m_first(block)
+		{
+		}
+
+		ArenaResource(const ArenaResource &) = delete;
+
+		~ArenaResource() override { _release_(); }
+
+		/**
+		 * @brief Rewind the arena, invalidates everything allocated from it. Blocks of a query that didn't fit are merged
+		 * into one so the next query fits.
+		 */
+		void reset()
+		{
+			if (m_blocks.size() > 1)
+			{
+				size_t total = 0;
+				for (const auto &b : m_blocks) total += b.size;
+				_release_();
+
+				m_blocks.push_back({ static_cast<std::byte *>(m_upstream->allocate(total, alignof(std::max_align_t))), total });
+			}
+
+			if (!m_blocks.empty())
+			{
+				m_pos = m_blocks.front().data;
+				m_end = m_pos + m_blocks.front().size;
+			}
+		}
+
+		/**
+		 * @brief Get the arena of the calling thread
+		 */
+		static auto local() -> ArenaResource &
+		{
+			thread_local ArenaResource a;
+			return a;
+		}
+
+	private:
+		struct _Block_
+		{
+			std::byte *data;
+			size_t	   size;
+		};
+
+		std::pmr::memory_resource *m_upstream;
+		size_t					   m_first;
+		std::vector<_Block_>	   m_blocks;
+		std::byte				  *m_pos = nullptr;
+		std::byte				  *m_end = nullptr;
+
+		auto do_allocate(size_t bytes, size_t align) -> void * override
+		{
+			auto p = (reinterpret_cast<uintptr_t>(m_pos) + align - 1) & ~(uintptr_t(align) - 1);
+			if (m_pos == nullptr || p + bytes > reinterpret_cast<uintptr_t>(m_end))
+			{
+				const auto size = std::max({ bytes + align, m_first, m_blocks.empty() ? 0 : m_blocks.back().size * 2 });
+				auto	  *data = static_cast<std::byte *>(m_upstream->allocate(size, alignof(std::max_align_t)));
+				m_blocks.push_back({ data, size });
+
+				m_end = data + size;
+				p	  = (reinterpret_cast<uintptr_t>(data) + align - 1) & ~(uintptr_t(align) - 1);
+			}
+
+			m_pos = reinterpret_cast<std::byte *>(p + bytes);
+			return reinterpret_cast<void *>(p);
+		}
+
+		void do_deallocate(void *, size_t, size_t) override {}
+
+		auto do_is_equal(const std::pmr::memory_resource &o) const noexcept -> bool override { return this == &o; }
+
+		void _release_() noexcept
+		{
+			for (const auto &b : m_blocks) m_upstream->deallocate(b.data, b.size, alignof(std::max_align_t));
+			m_blocks.clear();
+			m_pos = m_end = nullptr;
+		}
+	};
+
 	// -----------------------------------------------------------------------------
 	// Algorithms
 	// -----------------------------------------------------------------------------
 
+	namespace detail
+	{
+		template<typename A, typename T>
+		using _rebind_t_ = typename std::allocator_traits<A>::template rebind_alloc<T>;
+
+		template<typename T, typename U, typename F, typename A>
+		auto _breadth_first_search_(const Graph<T, U> &g, size_t start_node, F &early_exit, const A &alloc)
+			-> std::vector<size_t, _rebind_t_<A, size_t>>
+		{
+			std::queue<size_t, std::deque<size_t, _rebind_t_<A, size_t>>> front(alloc); // Store nodes to query
+			front.push(start_node);
+
+			std::vector<size_t, _rebind_t_<A, size_t>> came_from(g.size, -1, alloc); // Map routes
+			came_from[start_node] = start_node;
+
+			while (!front.empty())
+			{
+				const auto c = front.front();
+				front.pop();
+
+				if (early_exit(c))
+					break;
+
+				for (auto i = g.edges + g.idx[c], e = g.edges + g.idx[c + 1]; i != e; ++i) // Visit all neighbors
+				{
+					const auto next = i->dest;
+
+					if (came_from[next] == -1) // Mark visited and store route
+					{
+						front.push(next);
+						came_from[next] = c;
+					}
+				}
+			}
+
+			return came_from;
+		}
+
+		/**
+		 * @brief Dijkstra's algorithm ordered by weight + heuristic, so A* with a heuristic and Dijkstra without
+		 */
+		template<typename T, typename U, typename F, typename H, typename A>
+		auto _best_first_search_(const Graph<T, U> &g, size_t start_node, F &early_exit, H &heuristic, const A &alloc)
+		{
+			using Entry = std::pair<uint32_t, size_t>;
+
+			std::priority_queue<Entry, std::vector<Entry, _rebind_t_<A, Entry>>, std::greater<>> front(
+				std::greater<>(), alloc); // Always take shortest route
+			front.emplace(uint32_t(heuristic(start_node)), start_node);
+
+			auto route = std::make_pair(
+				std::vector<size_t, _rebind_t_<A, size_t>>(g.size, -1, alloc),
+				std::vector<uint32_t, _rebind_t_<A, uint32_t>>(g.size, -1, alloc)); // Visited node route and total weight
+
+			route.first[start_node]	 = start_node;
+			route.second[start_node] = 0u;
+
+			while (!front.empty())
+			{
+				const auto [w, idx] = front.top();
+				front.pop();
+
+				if (w > route.second[idx] + uint32_t(heuristic(idx))) // Outdated entry of a node reached cheaper since
+					continue;
+
+				if (early_exit(idx, w))
+					break;
+
+				for (auto i = g.edges + g.idx[idx], e = g.edges + g.idx[idx + 1]; i != e;
+					 ++i) // Go through all neighbors of the current node
+				{
+					const auto [next, weight] = *i;
+					const auto cost			  = route.second[idx] + weight;
+
+					if (route.second[next] == uint32_t(-1)
+						|| cost < route.second[next]) // If not visited or previous route to node weighs more
+					{
+						route.second[next] = cost;
+						route.first[next]  = idx;
+						front.emplace(cost + uint32_t(heuristic(next)), next);
+					}
+				}
+			}
+
+			return route;
+		}
+	} // namespace detail
+
 	/**
 	 * @brief Uses the breadth first search algorithm to map out a graph and return a vector for the shortest path for
 	 * each node.
@@ -56,33 +255,25 @@ namespace utl
 	[[nodiscard]] auto breadth_first_search(const Graph<T, U> &g, size_t start_node, F early_exit) noexcept
 		-> std::vector<size_t>
 	{
-		std::queue<size_t> front; // Store nodes to query
-		front.push(start_node);
-
-		std::vector<size_t> came_from(g.size, -1); // Map routes
-		came_from[start_node] = start_node;
-
-		while (!front.empty())
-		{
-			const auto c = front.front();
-			front.pop();
-
-			if (early_exit(c))
-				break;
-
-			for (auto i = g.edges + g.idx[c], e = g.edges + g.idx[c + 1]; i != e; ++i) // Visit all neighbors
-			{
-				const auto next = i->dest;
-
-				if (came_from[next] == -1) // Mark visited and store route
-				{
-					front.push(next);
-					came_from[next] = c;
-				}
-			}
-		}
+		UTL_PROFILE_SCOPE("breadth_first_search");
+		return detail::_breadth_first_search_(g, start_node, early_exit, std::allocator<size_t>());
+	}
 
-		return came_from;
+	/**
+	 * @brief Breadth first search taking all memory from a resource, see above
+	 *
+	 * @param g Graph to seach on
+	 * @param start_node Node index to start mapping from
+	 * @param early_exit Predicate
+	 * @param mr Resource of the buffers and the result, for example ArenaResource::local()
+	 * @return Row of indexes each pointing to another index in direction of the start node
+	 */
+	template<typename T, typename U, std::predicate<size_t> F>
+	[[nodiscard]] auto breadth_first_search(const Graph<T, U> &g, size_t start_node, F early_exit,
+											std::pmr::memory_resource *mr) -> std::pmr::vector<size_t>
+	{
+		UTL_PROFILE_SCOPE("breadth_first_search");
+		return detail::_breadth_first_search_(g, start_node, early_exit, std::pmr::polymorphic_allocator<size_t>(mr));
 	}
 
 	/**
@@ -114,40 +305,30 @@ namespace utl
 	template<typename T, typename U, std::predicate<size_t, uint32_t> F>
 	[[nodiscard]] auto dijkstra_search(const Graph<T, U> &g, size_t start_node, F early_exit)
 	{
-		std::priority_queue<std::pair<uint32_t, size_t>> front; // Always take shortest route
-		front.emplace(0u, start_node);
-
-		auto route = std::make_pair(std::vector<size_t>(g.size, -1),
-									std::vector<uint32_t>(g.size, -1)); // Visited node route and total weight
-
-		route.first[start_node]	 = start_node;
-		route.second[start_node] = 0u;
-
-		while (!front.empty())
-		{
-			const auto [w, idx] = front.top();
-			front.pop();
-
-			if (early_exit(idx, w))
-				break;
+		UTL_PROFILE_SCOPE("dijkstra_search");
 
-			for (auto i = &g.edges[g.idx[idx]]; i != &g.edges[g.idx[idx + 1]];
-				 ++i) // Go through all neighbors of the current node
-			{
-				const auto [next, weight] = *i;
-				const auto cost			  = route.second[idx] + weight;
+		auto none = [](size_t) constexpr { return 0u; };
+		return detail::_best_first_search_(g, start_node, early_exit, none, std::allocator<size_t>());
+	}
 
-				if (route.second[next] == -1
-					|| cost < route.second[next]) // If not visited or previous route to node weighs more
-				{
-					route.second[next] = cost;
-					route.first[next]  = idx;
-					front.emplace(cost, next);
-				}
-			}
-		}
+	/**
+	 * @brief Dijkstra search taking all memory from a resource, see above
+	 *
+	 * @param g Graph to seach on
+	 * @param start_node Node index to start mapping from
+	 * @param early_exit Predicate
+	 * @param mr Resource of the buffers and the result, for example ArenaResource::local()
+	 * @return Pair of vectors: Row of indexes towards the start_node; Total weigh for each destination
+	 */
+	template<typename T, typename U, std::predicate<size_t, uint32_t> F>
+	[[nodiscard]] auto dijkstra_search(const Graph<T, U> &g, size_t start_node, F early_exit,
+									   std::pmr::memory_resource *mr)
+	{
+		UTL_PROFILE_SCOPE("dijkstra_search");
 
-		return route;
+		auto none = [](size_t) constexpr { return 0u; };
+		return detail::_best_first_search_(g, start_node, early_exit, none,
+										   std::pmr::polymorphic_allocator<size_t>(mr));
 	}
 
 	/**
@@ -180,39 +361,27 @@ namespace utl
 	template<typename T, typename U, std::predicate<size_t, uint32_t> F1, std::predicate<size_t> F2>
 	[[nodiscard]] auto a_star(const Graph<T, U> &g, size_t start_node, F1 early_exit, F2 heuristic)
 	{
-		std::priority_queue<std::pair<uint32_t, size_t>> front; // Always take shortest route
-		front.emplace(0u, start_node);
-
-		auto route = std::make_pair(std::vector<size_t>(g.size, -1),
-									std::vector<uint32_t>(g.size, -1)); // Visited node route and total weight
-
-		route.first[start_node]	 = start_node;
-		route.second[start_node] = 0u;
-
-		while (!front.empty())
-		{
-			const auto [w, idx] = front.top();
-			front.pop();
-
-			if (early_exit(idx, w))
-				break;
-
-			for (const auto &i : g.neighbors(idx)) // Go through all neighbors of the current node
-			{
-				const auto [next, weight] = i;
-				const auto cost			  = route.second[idx] + weight;
-
-				if (route.first[next] == -1
-					|| cost < route.second[next]) // If not visited or previous route to node weighs more
-				{
-					route.first[next]  = idx;
-					route.second[next] = cost;
-					front.emplace(cost + heuristic(next), next);
-				}
-			}
-		}
+		UTL_PROFILE_SCOPE("a_star");
+		return detail::_best_first_search_(g, start_node, early_exit, heuristic, std::allocator<size_t>());
+	}
 
-		return route;
+	/**
+	 * @brief A* search taking all memory from a resource, see above
+	 *
+	 * @param g Graph to seach on
+	 * @param start_node Node index to start mapping from
+	 * @param early_exit Predicate
+	 * @param heuristic heuristic for goal
+	 * @param mr Resource of the buffers and the result, for example ArenaResource::local()
+	 * @return Row of indexes towards the start_node
+	 */
+	template<typename T, typename U, std::predicate<size_t, uint32_t> F1, std::predicate<size_t> F2>
+	[[nodiscard]] auto a_star(const Graph<T, U> &g, size_t start_node, F1 early_exit, F2 heuristic,
+							  std::pmr::memory_resource *mr)
+	{
+		UTL_PROFILE_SCOPE("a_star");
+		return detail::_best_first_search_(g, start_node, early_exit, heuristic,
+										   std::pmr::polymorphic_allocator<size_t>(mr));
 	}
 
 	/**
@@ -234,6 +403,209 @@ namespace utl
 			g, start, [&goal](size_t c, auto) { return c == goal; }, heuristic);
 	}
 
+	/**
+	 * @brief A* search to a goal taking all memory from a resource, see above
+	 */
+	template<typename T, typename U, std::predicate<size_t> F>
+	[[nodiscard]] auto a_star(const Graph<T, U> &g, size_t start, size_t goal, F heuristic, std::pmr::memory_resource *mr)
+	{
+		return a_star(
+			g, start, [&goal](size_t c, auto) { return c == goal; }, heuristic, mr);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Distance tables
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Distances from each source (row) to each target (column), row-major, -1 if unreachable
+	 */
+	struct DistanceTable
+	{
+		size_t				  rows;
+		size_t				  cols;
+		std::vector<uint32_t> data;
+
+		[[nodiscard]] auto operator()(size_t s, size_t t) const noexcept -> uint32_t { return data[s * cols + t]; }
+		[[nodiscard]] auto row(size_t s) const noexcept -> std::span<const uint32_t> { return { data.data() + s * cols, cols }; }
+	};
+
+	namespace detail
+	{
+		constexpr size_t _TABLE_LANES_ = 16;  // Sources searched together, a distance vector per node
+		constexpr size_t _TABLE_TILE_  = 256; // Targets written per pass over the rows of a block
+
+		template<typename E>
+		constexpr auto _edge_weight_(const E &e) noexcept -> uint32_t
+		{
+			if constexpr (std::is_same_v<E, WeighedEdge>)
+				return e.weight;
+			else
+				return 1;
+		}
+
+		/**
+		 * @brief Search from up to _TABLE_LANES_ sources at once. Every node holds a distance per source, relaxing an
+		 * edge is a vector add and min which the compiler vectorizes. Nodes are ordered by their smallest improved
+		 * distance, which makes it a label correcting Dijkstra. Stops once no target can improve anymore.
+		 *
+		 * @param dist Distance vectors of all nodes, overwritten
+		 * @param queued Key each node is queued with, overwritten
+		 */
+		template<typename T, typename U>
+		void _many_to_many_block_(const Graph<T, U> &g, std::span<const size_t> sources, std::span<const size_t> targets,
+								  uint32_t *dist, uint32_t *queued)
+		{
+			constexpr auto K   = _TABLE_LANES_;
+			constexpr auto INF = uint32_t(-1);
+
+			std::fill(dist, dist + g.size * K, INF);
+			std::fill(queued, queued + g.size, INF);
+
+			using Entry = std::pair<uint32_t, size_t>;
+			std::priority_queue<Entry, std::vector<Entry>, std::greater<>> front;
+
+			for (size_t k = 0; k < sources.size(); ++k)
+			{
+				dist[sources[k] * K + k] = 0;
+				queued[sources[k]]		 = 0;
+			}
+			for (const auto s : sources) front.emplace(0, s);
+
+			// Target distances not above the smallest key are final, checked again after the keys grew by an eighth
+			uint32_t check = 0;
+
+			while (!front.empty())
+			{
+				const auto [key, u] = front.top();
+				front.pop();
+
+				if (key != queued[u]) // Queued again with a smaller key or already done
+					continue;
+				queued[u] = INF;
+
+				if (key >= check)
+				{
+					uint32_t bound = 0;
+					for (const auto t : targets)
+						for (size_t k = 0; k < sources.size(); ++k) bound = std::max(bound, dist[t * K + k]);
+
+					if (key >= bound)
+						break;
+					check = std::min(bound, key + key / 8 + 1);
+				}
+
+				const auto *du = dist + u * K;
+				for (auto i = g.edges + g.idx[u], e = g.edges + g.idx[u + 1]; i != e; ++i)
+				{
+					const auto w  = _edge_weight_(*i);
+					auto	  *dv = dist + i->dest * K;
+
+					uint32_t best = INF; // Smallest improved distance
+					for (size_t k = 0; k < K; ++k)
+					{
+						const auto c = std::min(du[k], INF - w) + w;
+						best		 = std::min(best, c < dv[k] ? c : INF);
+						dv[k]		 = std::min(dv[k], c);
+					}
+
+					if (best < queued[i->dest])
+					{
+						queued[i->dest] = best;
+						front.emplace(best, i->dest);
+					}
+				}
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Compute the distances between every source and target. Sources are searched in blocks of 16 at once and
+	 * the blocks run in parallel, so the graph is traversed once per block instead of once per source.
+	 *
+	 * @param s Scheduler to run the blocks on
+	 * @param g Graph to seach on
+	 * @param sources Nodes of the rows
+	 * @param targets Nodes of the columns
+	 * @return Table of |sources| x |targets| distances
+	 */
+	template<typename T, typename U>
+	[[nodiscard]] auto distance_table(Scheduler &s, const Graph<T, U> &g, std::span<const size_t> sources,
+									  std::span<const size_t> targets) -> DistanceTable
+	{
+		UTL_PROFILE_SCOPE("distance_table");
+
+		constexpr auto K = detail::_TABLE_LANES_;
+
+		DistanceTable res = { .rows = sources.size(), .cols = targets.size(), .data = {} };
+		res.data.resize(res.rows * res.cols);
+
+		const auto blocks = (sources.size() + K - 1) / K;
+
+		// Search buffers, left uninitialised since every block fills them. Reused by the blocks, so at most one set per
+		// worker is allocated and all are freed with the call.
+		struct Buffers
+		{
+			std::unique_ptr<uint32_t[]> dist;
+			std::unique_ptr<uint32_t[]> queued;
+		};
+
+		std::mutex			 mutex;
+		std::vector<Buffers> pool;
+
+		parallel_for(
+			s, 0, blocks,
+			[&](size_t b, size_t e) {
+				Buffers buf;
+				{
+					std::scoped_lock l(mutex);
+					if (!pool.empty())
+					{
+						buf = std::move(pool.back());
+						pool.pop_back();
+					}
+				}
+				if (!buf.dist)
+					buf = { .dist	= std::make_unique_for_overwrite<uint32_t[]>(g.size * K),
+							.queued = std::make_unique_for_overwrite<uint32_t[]>(g.size) };
+
+				const auto *dist = buf.dist.get();
+				for (auto blk = b; blk < e; ++blk)
+				{
+					const auto first = blk * K;
+					const auto srcs	 = sources.subspan(first, std::min(K, sources.size() - first));
+					detail::_many_to_many_block_(g, srcs, targets, buf.dist.get(), buf.queued.get());
+
+					// Tiles of targets, so their distance vectors stay in cache while the rows are written
+					for (size_t t0 = 0; t0 < targets.size(); t0 += detail::_TABLE_TILE_)
+					{
+						const auto t1 = std::min(t0 + detail::_TABLE_TILE_, targets.size());
+						for (size_t k = 0; k < srcs.size(); ++k)
+						{
+							auto *out = res.data.data() + (first + k) * res.cols;
+							for (auto t = t0; t < t1; ++t) out[t] = dist[targets[t] * K + k];
+						}
+					}
+				}
+
+				std::scoped_lock l(mutex);
+				pool.emplace_back(std::move(buf));
+			},
+			1);
+
+		return res;
+	}
+
+	/**
+	 * @brief Compute the distances between every source and target on the shared scheduler, see above
+	 */
+	template<typename T, typename U>
+	[[nodiscard]] auto distance_table(const Graph<T, U> &g, std::span<const size_t> sources,
+									  std::span<const size_t> targets) -> DistanceTable
+	{
+		return distance_table(Scheduler::instance(), g, sources, targets);
+	}
+
 } // namespace utl
 
 #endif
\ No newline at end of file
@@ -5,16 +5,226 @@
 #include <cassert>
 #include <string_view>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "Scan.h"
 
 namespace utl
 {
+	namespace detail
+	{
+		constexpr auto _is_digit_(char c) noexcept -> bool { return c >= '0' && c <= '9'; }
+
+		/**
+		 * @brief Check if 8 bytes loaded little endian are all decimal digits
+		 */
+		constexpr auto _is_8_digits_(uint64_t v) noexcept -> bool
+		{
+			return ((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+				== 0x3333333333333333;
+		}
+
+		/**
+		 * @brief Convert 8 digits loaded little endian using 3 multiplications
+		 */
+		constexpr auto _parse_8_digits_(uint64_t v) noexcept -> uint32_t
+		{
+			constexpr uint64_t mask = 0x000000FF000000FF;
+			constexpr uint64_t mul1 = 0x000F424000000064; // 100 + (1000000 << 32)
+			constexpr uint64_t mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+
+			v -= 0x3030303030303030;
+			v = (v * 10) + (v >> 8); // Combine digit pairs
+			v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+
+			return static_cast<uint32_t>(v);
+		}
+
+		/**
+		 * @brief Parse an unsigned decimal number. Takes 8 digits per step when possible.
+		 * @return end of the number or nullptr on missing digits or overflow
+		 */
+		constexpr auto _parse_uint_(const char *b, const char *e, uint64_t &out) noexcept -> const char *
+		{
+			constexpr auto max = std::numeric_limits<uint64_t>::max();
+
+			auto	 p	 = b;
+			uint64_t res = 0;
+
+			if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+				for (uint64_t v; e - p >= 8; p += 8)
+				{
+					std::memcpy(&v, p, sizeof v);
+					if (!_is_8_digits_(v))
+						break;
+
+					const auto d = _parse_8_digits_(v);
+					if (res > (max - d) / 100000000)
+						return nullptr;
+					res = res * 100000000 + d;
+				}
+
+			for (; p != e && _is_digit_(*p); ++p)
+			{
+				const auto d = static_cast<uint64_t>(*p - '0');
+				if (res > (max - d) / 10)
+					return nullptr;
+				res = res * 10 + d;
+			}
+
+			if (p == b)
+				return nullptr;
+
+			out = res;
+			return p;
+		}
+
+		/**
+		 * @brief Parse an integer with an optional '-' for signed types
+		 * @return end of the number or nullptr on error
+		 */
+		template<std::integral T>
+		constexpr auto _parse_int_(const char *b, const char *e, T &out) noexcept -> const char *
+		{
+			bool neg = false;
+			if constexpr (std::is_signed_v<T>)
+				if (b != e && *b == '-')
+				{
+					neg = true;
+					++b;
+				}
+
+			uint64_t   mag;
+			const auto p = _parse_uint_(b, e, mag);
+			if (p == nullptr)
+				return nullptr;
+
+			const auto limit = static_cast<uint64_t>(std::numeric_limits<T>::max()) + neg;
+			if (mag > limit)
+				return nullptr;
+
+			out = static_cast<T>(neg ? ~mag + 1 : mag);
+			return p;
+		}
+
+		template<typename T>
+		constexpr auto _keyword_nodes_(const T &keywords) noexcept -> size_t
+		{
+			size_t res = 1; // Root
+			for (const auto &k : keywords) res += std::string_view(k).size();
+			return res;
+		}
+
+		template<typename T>
+		constexpr auto _keyword_chars_(const T &keywords) noexcept -> size_t
+		{
+			std::array<bool, 256> used{};
+			for (const auto &k : keywords)
+				for (const auto c : std::string_view(k)) used[static_cast<unsigned char>(c)] = true;
+			return std::count(used.begin(), used.end(), true);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Keyword trie built at compile time. Characters are mapped to dense classes so every node is a small
+	 * transition row and matching is one table lookup per character.
+	 *
+	 * @tparam keywords Static array of strings to match
+	 */
+	template<const auto &keywords>
+	class KeywordMatcher
+	{
+		static constexpr size_t COUNT	= std::size(keywords);
+		static constexpr size_t NODES	= detail::_keyword_nodes_(keywords);
+		static constexpr size_t CLASSES = detail::_keyword_chars_(keywords) + 1; // Class 0 is unused characters
+
+		using index_t = std::conditional_t<NODES <= std::numeric_limits<uint16_t>::max(), uint16_t, uint32_t>;
+
+		struct Table
+		{
+			std::array<uint16_t, 256>			  classes{};
+			std::array<index_t, NODES * CLASSES> next{};	// Node 0 doubles as missing transition
+			std::array<uint32_t, NODES>			  accept{}; // Keyword index + 1, 0 for none
+		};
+
+		static constexpr Table TABLE = []
+		{
+			Table t;
+
+			uint16_t cls = 0;
+			for (const auto &k : keywords)
+				for (const auto c : std::string_view(k))
+					if (auto &v = t.classes[static_cast<unsigned char>(c)]; v == 0)
+						v = ++cls;
+
+			size_t nodes = 1;
+			for (size_t i = 0; i < COUNT; ++i)
+			{
+				size_t node = 0;
+				for (const auto c : std::string_view(keywords[i]))
+				{
+					auto &next = t.next[node * CLASSES + t.classes[static_cast<unsigned char>(c)]];
+					if (next == 0)
+						next = static_cast<index_t>(nodes++);
+					node = next;
+				}
+
+				if (t.accept[node] == 0) // First one wins on duplicates
+					t.accept[node] = static_cast<uint32_t>(i + 1);
+			}
+
+			return t;
+		}();
+
+	public:
+		constexpr KeywordMatcher() = default;
+
+		/**
+		 * @brief Find the longest keyword the string begins with
+		 * @param str String to match
+		 * @return index of the keyword, null object if none matches
+		 */
+		[[nodiscard]] constexpr auto match(std::string_view str) const noexcept -> std::optional<size_t>
+		{
+			size_t node = 0;
+			auto   best = TABLE.accept[0];
+
+			for (const auto c : str)
+			{
+				const auto cls = TABLE.classes[static_cast<unsigned char>(c)];
+				if (cls == 0 || (node = TABLE.next[node * CLASSES + cls]) == 0)
+					break;
+
+				if (TABLE.accept[node] != 0)
+					best = TABLE.accept[node];
+			}
+
+			return best == 0 ? std::nullopt : std::optional<size_t>(best - 1);
+		}
+
+		/**
+		 * @brief Get the amount of keywords
+		 * @return The amount
+		 */
+		[[nodiscard]] static constexpr auto size() noexcept -> size_t { return COUNT; }
+	};
+
 	/**
 	 * @brief Basic parser used to analyze strings.
 	 */
 	class SequentialParser
 	{
 	public:
-		static constexpr auto WHITESPACES = " \n\t";
+		static constexpr auto	 WHITESPACES	= " \n\t";
+		static constexpr CharSet WHITESPACE_SET = CharSet(WHITESPACES);
 
 		constexpr SequentialParser() = default;
 
@@ -46,7 +256,7 @@ namespace utl
 		 */
 		[[nodiscard]] constexpr auto find(char delim) const noexcept -> std::optional<size_t>
 		{
-			const auto res = m_data.find(delim, m_loc);
+			const auto res = find_char(m_data, delim, m_loc);
 			return res == std::string_view::npos ? std::nullopt : std::optional(res);
 		}
 
@@ -57,7 +267,20 @@ namespace utl
 		 */
 		constexpr auto get_until(char delim) noexcept -> std::optional<std::string_view>
 		{
-			if (const auto loc = m_data.find(delim, current_loc()); loc != std::string_view::npos)
+			if (const auto loc = find_char(m_data, delim, current_loc()); loc != std::string_view::npos)
+				return get_until((ptrdiff_t)(loc - m_loc));
+
+			return std::nullopt;
+		}
+
+		/**
+		 * @brief Get the string until any of the delimiters is found. Moves the start ptr to the delimiter
+		 * @param delims Characters to get till
+		 * @return string or null object when none of the delims is found
+		 */
+		constexpr auto get_until(const CharSet &delims) noexcept -> std::optional<std::string_view>
+		{
+			if (const auto loc = find_first_of(m_data, delims, current_loc()); loc != std::string_view::npos)
 				return get_until((ptrdiff_t)(loc - m_loc));
 
 			return std::nullopt;
@@ -83,7 +306,7 @@ namespace utl
 		 */
 		constexpr void skip_till(char delim) noexcept
 		{
-			if (const auto loc = m_data.find(delim, m_loc); loc != std::string_view::npos)
+			if (const auto loc = find_char(m_data, delim, m_loc); loc != std::string_view::npos)
 				seek(loc + 1);
 		}
 		/**
@@ -96,7 +319,7 @@ namespace utl
 		 */
 		constexpr void skip_space() noexcept
 		{
-			if (const auto i = m_data.find_first_not_of(WHITESPACES, current_loc()); i != std::string_view::npos)
+			if (const auto i = find_first_not_of(m_data, WHITESPACE_SET, current_loc()); i != std::string_view::npos)
 				seek(i);
 			else
 				seek(total_size());
@@ -111,10 +334,10 @@ namespace utl
 		 */
 		constexpr auto is_same(std::string_view str) noexcept -> bool
 		{
-			if (remaining() < total_size())
+			if (size_t(remaining()) < str.size())
 				return false;
 
-			const auto res = std::equal(&m_data[current_loc()], &m_data[_displace_(str.size() - 1)], str.data());
+			const auto res = rest().starts_with(str);
 
 			if (res)
 				skip_for(str.size());
@@ -161,6 +384,63 @@ namespace utl
 			return c;
 		}
 
+		/**
+		 * @brief Read a number in place. Integers are decimal with an optional '-' for signed types, floating point
+		 * numbers use std::from_chars.
+		 * @tparam T Integer or floating point type
+		 * @return number or null object on missing digits or overflow. Moves the ptr only on success
+		 */
+		template<typename T>
+		requires(std::integral<T> && !std::same_as<T, bool>) || std::floating_point<T>
+		constexpr auto get() noexcept -> std::optional<T>
+		{
+			const auto b = m_data.data() + current_loc();
+			const auto e = m_data.data() + total_size();
+
+			T res;
+
+			if constexpr (std::floating_point<T>)
+			{
+				const auto [p, ec] = std::from_chars(b, e, res);
+				if (ec != std::errc())
+					return std::nullopt;
+				seek(p - m_data.data());
+			}
+			else
+			{
+				const auto p = detail::_parse_int_(b, e, res);
+				if (p == nullptr)
+					return std::nullopt;
+				seek(p - m_data.data());
+			}
+
+			return res;
+		}
+
+		/**
+		 * @brief Read a hexadecimal integer in place. An optional "0x" prefix is skipped.
+		 * @tparam T Integer type
+		 * @return number or null object on missing digits or overflow. Moves the ptr only on success
+		 */
+		template<std::integral T>
+		auto get_hex() noexcept -> std::optional<T>
+		{
+			auto	   b = m_data.data() + current_loc();
+			const auto e = m_data.data() + total_size();
+
+			if (e - b > 2 && b[0] == '0' && (b[1] == 'x' || b[1] == 'X') && std::isxdigit((unsigned char)b[2]))
+				b += 2;
+
+			T res;
+			if (const auto [p, ec] = std::from_chars(b, e, res, 16); ec == std::errc())
+			{
+				seek(p - m_data.data());
+				return res;
+			}
+
+			return std::nullopt;
+		}
+
 		/**
 		 * @brief Check if parser is at the end
 		 * @return true Is at the end
@@ -186,7 +466,7 @@ namespace utl
 		 */
 		[[nodiscard]] constexpr auto remaining() const noexcept -> ptrdiff_t
 		{
-			assert(current_loc() > total_size() && "String ptr out of bounds");
+			assert(current_loc() <= total_size() && "String ptr out of bounds");
 			return total_size() - current_loc();
 		}
 
@@ -223,7 +503,7 @@ namespace utl
 		 */
 		constexpr auto take() noexcept -> std::string_view
 		{
-			const auto		 res = m_data.find_first_of(WHITESPACES, current_loc());
+			const auto		 res = find_first_of(m_data, WHITESPACE_SET, current_loc());
 			std::string_view ret;
 
 			if (res != std::string_view::npos)
@@ -265,6 +545,23 @@ namespace utl
 			return i;
 		}
 
+		/**
+		 * @brief check if buffer begins with one of the matcher keywords and consume the longest one.
+		 *
+		 * @param matcher Compiled keywords
+		 * @return iterator to the found keyword or end iterator if not available
+		 */
+		template<const auto &keywords>
+		constexpr auto get_one_of(const KeywordMatcher<keywords> &matcher) noexcept
+		{
+			const auto i = matcher.match(rest());
+			if (!i)
+				return std::end(keywords);
+
+			m_loc = _displace_(std::string_view(keywords[*i]).size());
+			return std::begin(keywords) + *i;
+		}
+
 	private:
 		[[nodiscard]] constexpr auto _displace_(ptrdiff_t diff) const noexcept -> size_t
 		{
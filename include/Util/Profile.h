@@ -0,0 +1,538 @@
+#if not defined _UTILLIB_PROFILE_
+#define _UTILLIB_PROFILE_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Error.h"
+
+#if defined __x86_64__ || defined __i386__
+#include <x86intrin.h>
+#endif
+
+#define _UTL_PROFILE_CAT_(a, b) a##b
+#define _UTL_PROFILE_NAME_(a, b) _UTL_PROFILE_CAT_(a, b)
+
+/**
+ * @brief Time the rest of the enclosing scope under a label. Compiled in only if UTL_PROFILE is defined, otherwise the
+ * statement is empty.
+ * Usage: UTL_PROFILE_SCOPE("dijkstra");
+ */
+#if defined UTL_PROFILE
+#define UTL_PROFILE_SCOPE(label)                                                                 \
+	static constinit ::utl::ProfileSite _UTL_PROFILE_NAME_(_utl_profile_site_, __LINE__)(label); \
+	const ::utl::ProfileScope			_UTL_PROFILE_NAME_(_utl_profile_scope_, __LINE__)(       \
+		  _UTL_PROFILE_NAME_(_utl_profile_site_, __LINE__))
+#else
+#define UTL_PROFILE_SCOPE(label) static_cast<void>(0)
+#endif
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Sites
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Static location timed by UTL_PROFILE_SCOPE. Gets an id the first time it is recorded.
+	 */
+	class ProfileSite
+	{
+	public:
+		explicit constexpr ProfileSite(std::string_view label) noexcept
+			: m_label(label)
+		{
+		}
+
+		ProfileSite(const ProfileSite &) = delete;
+
+		[[nodiscard]] constexpr auto label() const noexcept -> std::string_view { return m_label; }
+
+		std::atomic<uint32_t> id = 0; // 0 until registered
+
+	private:
+		std::string_view m_label;
+	};
+
+	namespace detail
+	{
+		// -----------------------------------------------------------------------------
+		// Clock
+		// -----------------------------------------------------------------------------
+
+		/**
+		 * @brief Cheapest monotonic tick counter, the TSC on x86 (assumed invariant) and steady_clock elsewhere
+		 */
+		inline auto _profile_ticks_() noexcept -> uint64_t
+		{
+#if defined __x86_64__ || defined __i386__
+			return __rdtsc();
+#else
+			return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+		}
+
+		struct _ProfileClock_
+		{
+			std::chrono::steady_clock::time_point time	= std::chrono::steady_clock::now();
+			uint64_t							  ticks = _profile_ticks_();
+		};
+
+		/**
+		 * @brief Reference point taken on the first recording
+		 */
+		inline auto _profile_clock_() noexcept -> const _ProfileClock_ &
+		{
+			static const _ProfileClock_ c;
+			return c;
+		}
+
+		/**
+		 * @brief Nanoseconds per tick, measured against steady_clock since the reference point
+		 */
+		inline auto _profile_tick_ns_() -> double
+		{
+#if defined __x86_64__ || defined __i386__
+			constexpr auto MIN_SPAN = std::chrono::milliseconds(10);
+
+			const auto &ref = _profile_clock_();
+			if (const auto span = std::chrono::steady_clock::now() - ref.time; span < MIN_SPAN)
+				std::this_thread::sleep_for(MIN_SPAN - span);
+
+			const _ProfileClock_ now;
+			return double(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time - ref.time).count())
+				/ double(now.ticks - ref.ticks);
+#else
+			return double(std::chrono::steady_clock::period::num) * 1e9 / double(std::chrono::steady_clock::period::den);
+#endif
+		}
+
+		// -----------------------------------------------------------------------------
+		// Histogram
+		// -----------------------------------------------------------------------------
+
+		/**
+		 * @brief Log-linear histogram of tick counts: exact below 64, above that each power of two is split into 32
+		 * buckets (about 3% precision). Only the owning thread writes, so increments are plain relaxed load and store.
+		 */
+		struct _ProfileHistogram_
+		{
+			static constexpr unsigned SUB	  = 6;
+			static constexpr uint64_t LINEAR  = uint64_t(1) << SUB;
+			static constexpr uint64_t HALF	  = LINEAR / 2;
+			static constexpr size_t	  BUCKETS = LINEAR + (64 - SUB) * HALF;
+
+			static constexpr auto bucket(uint64_t v) noexcept -> size_t
+			{
+				const auto b = unsigned(std::bit_width(v));
+				if (b <= SUB)
+					return v;
+
+				const auto shift = b - SUB;
+				return LINEAR + (shift - 1) * HALF + (v >> shift) - HALF;
+			}
+
+			/**
+			 * @brief Highest value falling into a bucket
+			 */
+			static constexpr auto bucket_max(size_t i) noexcept -> uint64_t
+			{
+				if (i < LINEAR)
+					return i;
+
+				const auto k	 = i - LINEAR;
+				const auto shift = k / HALF + 1;
+				return ((k % HALF + HALF + 1) << shift) - 1;
+			}
+
+			explicit _ProfileHistogram_(uint32_t site)
+				: site(site)
+			{
+			}
+
+			void add(uint64_t v) noexcept
+			{
+				_bump_(counts[bucket(v)], 1);
+				_bump_(sum, v);
+				if (v > max.load(std::memory_order_relaxed))
+					max.store(v, std::memory_order_relaxed);
+			}
+
+			uint32_t								   site;
+			_ProfileHistogram_						  *next = nullptr;
+			std::array<std::atomic<uint64_t>, BUCKETS> counts {};
+			std::atomic<uint64_t>					   sum = 0;
+			std::atomic<uint64_t>					   max = 0;
+
+		private:
+			static void _bump_(std::atomic<uint64_t> &a, uint64_t v) noexcept
+			{
+				a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+			}
+		};
+
+		static_assert(_ProfileHistogram_::bucket(~uint64_t(0)) == _ProfileHistogram_::BUCKETS - 1);
+		static_assert(_ProfileHistogram_::bucket_max(_ProfileHistogram_::bucket(1000)) >= 1000);
+
+		// -----------------------------------------------------------------------------
+		// Registry
+		// -----------------------------------------------------------------------------
+
+		/**
+		 * @brief Histograms of one thread as a list only ever pushed to, readable while the thread records
+		 */
+		struct _ProfileThread_
+		{
+			std::atomic<_ProfileHistogram_ *> head = nullptr;
+
+			~_ProfileThread_()
+			{
+				for (auto *h = head.load(std::memory_order_relaxed); h != nullptr;) delete std::exchange(h, h->next);
+			}
+		};
+
+		/**
+		 * @brief Every site and thread ever recorded. Threads are kept after they exit so their samples stay.
+		 */
+		struct _ProfileRegistry_
+		{
+			std::mutex									  mutex;
+			std::vector<const ProfileSite *>			  sites; // Indexed by id - 1
+			std::vector<std::shared_ptr<_ProfileThread_>> threads;
+		};
+
+		inline auto _profile_registry_() -> _ProfileRegistry_ &
+		{
+			static _ProfileRegistry_ r;
+			return r;
+		}
+
+		/**
+		 * @brief Thread side of the registry, maps site ids to the histograms of this thread
+		 */
+		class _ProfileRecorder_
+		{
+		public:
+			_ProfileRecorder_()
+				: m_thread(std::make_shared<_ProfileThread_>())
+			{
+				auto		&r = _profile_registry_();
+				std::scoped_lock l(r.mutex);
+				r.threads.emplace_back(m_thread);
+			}
+
+			void record(ProfileSite &site, uint64_t ticks) noexcept
+			{
+				const auto id = site.id.load(std::memory_order_acquire);
+				if (id < m_local.size() && m_local[id] != nullptr) [[likely]]
+					m_local[id]->add(ticks);
+				else
+					_record_slow_(site, ticks);
+			}
+
+		private:
+			std::shared_ptr<_ProfileThread_>  m_thread;
+			std::vector<_ProfileHistogram_ *> m_local;
+
+			void _record_slow_(ProfileSite &site, uint64_t ticks) noexcept
+			{
+				_profile_clock_(); // Calibrate the ticks over the whole run, not just the first collect
+
+				try
+				{
+					auto id = site.id.load(std::memory_order_acquire);
+					if (id == 0)
+					{
+						auto		&r = _profile_registry_();
+						std::scoped_lock l(r.mutex);
+						if (id = site.id.load(std::memory_order_relaxed); id == 0)
+						{
+							r.sites.emplace_back(&site);
+							id = uint32_t(r.sites.size());
+							site.id.store(id, std::memory_order_release);
+						}
+					}
+
+					if (id >= m_local.size())
+						m_local.resize(id + 1, nullptr);
+
+					auto *h = new _ProfileHistogram_(id);
+					h->add(ticks);
+					h->next = m_thread->head.load(std::memory_order_relaxed);
+					m_thread->head.store(h, std::memory_order_release);
+					m_local[id] = h;
+				}
+				catch (...)
+				{
+					// Out of memory, drop the sample
+				}
+			}
+		};
+
+		inline auto _profile_recorder_() -> _ProfileRecorder_ &
+		{
+			thread_local _ProfileRecorder_ r;
+			return r;
+		}
+
+		/**
+		 * @brief Cumulative counts of a label merged over sites and threads
+		 */
+		struct _ProfileTotals_
+		{
+			std::string_view									   label;
+			std::array<uint64_t, _ProfileHistogram_::BUCKETS> counts {};
+			uint64_t											   sum = 0;
+			uint64_t											   max = 0;
+		};
+
+		inline auto _profile_totals_() -> std::vector<_ProfileTotals_>
+		{
+			auto		&r = _profile_registry_();
+			std::scoped_lock l(r.mutex);
+
+			std::vector<_ProfileTotals_> res;
+			std::vector<size_t>			 slot(r.sites.size());
+			for (size_t i = 0; i < r.sites.size(); ++i)
+			{
+				const auto label = r.sites[i]->label();
+				const auto iter	 = std::find_if(res.begin(), res.end(), [&](const auto &t) { return t.label == label; });
+				slot[i]			 = size_t(iter - res.begin());
+				if (iter == res.end())
+					res.emplace_back().label = label;
+			}
+
+			for (const auto &t : r.threads)
+				for (auto *h = t->head.load(std::memory_order_acquire); h != nullptr; h = h->next)
+				{
+					auto &dst = res[slot[h->site - 1]];
+					for (size_t i = 0; i < h->counts.size(); ++i) dst.counts[i] += h->counts[i].load(std::memory_order_relaxed);
+					dst.sum += h->sum.load(std::memory_order_relaxed);
+					dst.max = std::max(dst.max, h->max.load(std::memory_order_relaxed));
+				}
+
+			return res;
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Recording
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Records the time from construction to destruction into the histogram of the site for this thread
+	 */
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(ProfileSite &site) noexcept
+			: m_site(site)
+			, m_start(detail::_profile_ticks_())
+		{
+		}
+
+		ProfileScope(const ProfileScope &) = delete;
+
+		~ProfileScope() { detail::_profile_recorder_().record(m_site, detail::_profile_ticks_() - m_start); }
+
+	private:
+		ProfileSite &m_site;
+		uint64_t	 m_start;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Aggregation
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Latency summary of a label, times in nanoseconds
+	 */
+	struct ProfileStats
+	{
+		std::string_view label;
+		uint64_t		 count;
+		uint64_t		 mean;
+		uint64_t		 p50;
+		uint64_t		 p90;
+		uint64_t		 p99;
+		uint64_t		 p999;
+		uint64_t		 max;
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Samples between two totals of a label. The max is the top of the highest bucket with new samples,
+		 * exact if the all time max is among them.
+		 */
+		inline auto _profile_delta_(const _ProfileTotals_ &now, const _ProfileTotals_ &last) noexcept -> _ProfileTotals_
+		{
+			auto res = now;
+			res.sum -= last.sum;
+			res.max	 = 0;
+
+			for (size_t i = 0; i < now.counts.size(); ++i)
+				if ((res.counts[i] -= last.counts[i]) != 0)
+					res.max = std::min(_ProfileHistogram_::bucket_max(i), now.max);
+
+			return res;
+		}
+
+		/**
+		 * @brief Summarize the samples of a label
+		 * @param tick_ns Nanoseconds per tick
+		 */
+		inline auto _profile_stats_(const _ProfileTotals_ &t, double tick_ns) noexcept -> ProfileStats
+		{
+			using H = _ProfileHistogram_;
+
+			ProfileStats s {};
+			s.label = t.label;
+			for (const auto c : t.counts) s.count += c;
+			if (s.count == 0)
+				return s;
+
+			auto ns = [tick_ns](uint64_t ticks) { return uint64_t(double(ticks) * tick_ns + 0.5); };
+
+			auto percentile = [&](double p) {
+				const auto rank = std::max<uint64_t>(1, uint64_t(p * double(s.count) + 0.999999));
+				uint64_t   seen = 0;
+				for (size_t i = 0; i < t.counts.size(); ++i)
+					if ((seen += t.counts[i]) >= rank)
+						return ns(std::min(H::bucket_max(i), t.max));
+				return ns(t.max);
+			};
+
+			s.mean = ns(t.sum / s.count);
+			s.p50  = percentile(0.5);
+			s.p90  = percentile(0.9);
+			s.p99  = percentile(0.99);
+			s.p999 = percentile(0.999);
+			s.max  = percentile(1);
+			return s;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Aggregates the histograms of all threads. Each call summarizes the samples recorded since the previous
+	 * one, the first call everything recorded so far. Recording threads are never blocked.
+	 */
+	class Profiler
+	{
+	public:
+		/**
+		 * @brief Summarize the samples since the last call
+		 * @return Stats of every label with samples
+		 */
+		[[nodiscard]] auto collect() -> std::vector<ProfileStats>
+		{
+			auto			   totals  = detail::_profile_totals_();
+			const auto		   tick_ns = detail::_profile_tick_ns_();
+			std::vector<ProfileStats> res;
+
+			for (auto &t : totals)
+			{
+				auto iter = std::find_if(m_last.begin(), m_last.end(), [&](const auto &l) { return l.label == t.label; });
+				if (iter == m_last.end())
+				{
+					iter		= m_last.emplace(m_last.end());
+					iter->label = t.label;
+				}
+
+				const auto delta = detail::_profile_delta_(t, *iter);
+				*iter			 = t;
+
+				if (auto s = detail::_profile_stats_(delta, tick_ns); s.count != 0)
+					res.emplace_back(s);
+			}
+
+			return res;
+		}
+
+	private:
+		std::vector<detail::_ProfileTotals_> m_last;
+	};
+
+	/**
+	 * @brief Write one line per label through a logger
+	 *
+	 * @param log Logger or AsyncLogger
+	 * @param stats Result of Profiler::collect
+	 * @param c Catagory to use
+	 */
+	template<typename Log>
+	void dump_profile(Log &log, const std::vector<ProfileStats> &stats, Catagory c = Catagory::INFO)
+	{
+		for (const auto &s : stats)
+			log.write(c) << "profile " << s.label << ": n=" << s.count << " mean=" << s.mean << "ns p50=" << s.p50
+						 << "ns p90=" << s.p90 << "ns p99=" << s.p99 << "ns p99.9=" << s.p999 << "ns max=" << s.max
+						 << "ns";
+	}
+
+	/**
+	 * @brief Background thread dumping the profile of each interval. The logger is written from that thread, so it has
+	 * to be safe to use concurrently, like AsyncLogger.
+	 */
+	template<typename Log>
+	class ProfileReporter
+	{
+	public:
+		/**
+		 * @brief Start reporting
+		 * @param log Logger to write to, must outlive the reporter
+		 * @param interval Time between reports
+		 * @param c Catagory to use
+		 */
+		ProfileReporter(Log &log, std::chrono::milliseconds interval, Catagory c = Catagory::INFO)
+			: m_log(log)
+			, m_thread([this, interval, c] { _run_(interval, c); })
+		{
+		}
+
+		ProfileReporter(const ProfileReporter &) = delete;
+
+		/**
+		 * @brief Stop and report the remaining samples
+		 */
+		~ProfileReporter()
+		{
+			{
+				std::scoped_lock l(m_mutex);
+				m_stop = true;
+			}
+			m_cv.notify_one();
+			m_thread.join();
+		}
+
+	private:
+		Log					   &m_log;
+		Profiler				m_profiler;
+		std::mutex				m_mutex;
+		std::condition_variable m_cv;
+		bool					m_stop = false;
+		std::thread				m_thread;
+
+		void _run_(std::chrono::milliseconds interval, Catagory c)
+		{
+			std::unique_lock l(m_mutex);
+			while (!m_stop)
+			{
+				m_cv.wait_for(l, interval, [this] { return m_stop; });
+				dump_profile(m_log, m_profiler.collect(), c);
+			}
+		}
+	};
+
+} // namespace utl
+
+#endif
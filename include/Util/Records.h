@@ -0,0 +1,240 @@
+#if not defined _UTILLIB_RECORDS_
+#define _UTILLIB_RECORDS_
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Profile.h"
+#include "Scan.h"
+#include "Scheduler.h"
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Structures
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Format of a delimited record file
+	 */
+	struct Dialect
+	{
+		char delim = ','; // Field separator, '\t' for TSV
+		char quote = '"'; // Fields inside quotes may contain delimiters and newlines
+	};
+
+	/**
+	 * @brief Records of one chunk. Fields point into the parsed buffer, surrounding quotes and a trailing '\r' are
+	 * stripped while escaped quotes ("") are kept as they are.
+	 */
+	class RecordChunk
+	{
+	public:
+		/**
+		 * @brief Get the amount of records
+		 * @return The amount
+		 */
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_ends.size(); }
+
+		/**
+		 * @brief Get the fields of a record
+		 * @param i Record index
+		 * @return fields
+		 */
+		[[nodiscard]] auto operator[](size_t i) const noexcept -> std::span<const std::string_view>
+		{
+			const auto b = i == 0 ? 0 : m_ends[i - 1];
+			return { m_fields.data() + b, m_ends[i] - b };
+		}
+
+	private:
+		std::vector<std::string_view> m_fields;
+		std::vector<size_t>			  m_ends; // Field end of each record
+
+		friend class RecordParser;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Parallel Helper
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Run tasks on the shared Scheduler
+		 * @param tasks Amount of tasks
+		 * @param threads Amount of threads to use at most, 1 runs the tasks on the calling thread
+		 * @param f Task taking its index
+		 */
+		template<typename F>
+		void _run_parallel_(size_t tasks, size_t threads, F &&f)
+		{
+			if (threads <= 1 || tasks <= 1)
+				for (size_t i = 0; i < tasks; ++i) f(i);
+			else
+				parallel_for(0, tasks, f, (tasks + threads - 1) / threads);
+		}
+
+		/**
+		 * @brief Split a buffer into equal ranges
+		 * @return Range separators, parts + 1 in size
+		 */
+		inline auto _split_(size_t size, size_t parts) -> std::vector<size_t>
+		{
+			std::vector<size_t> res(parts + 1);
+			for (size_t i = 0; i <= parts; ++i) res[i] = size * i / parts;
+			return res;
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Parser
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Parses delimited records (CSV, TSV) in parallel. The buffer is cut into ranges whose quote state is found
+	 * with a counting pass, every range then starts at its first unquoted newline and builds a structural index of 64
+	 * bytes per step.
+	 */
+	class RecordParser
+	{
+	public:
+		/**
+		 * @brief Create the parser
+		 * @param d Format of the records
+		 * @param threads Amount of threads to use
+		 */
+		explicit RecordParser(Dialect d = {}, size_t threads = std::thread::hardware_concurrency())
+			: m_dialect(d)
+			, m_threads(std::max<size_t>(threads, 1))
+		{
+		}
+
+		/**
+		 * @brief Parse the records of a buffer
+		 * @param data Buffer to parse, must outlive the results
+		 * @return Chunks of records in order
+		 */
+		[[nodiscard]] auto parse(std::string_view data) const -> std::vector<RecordChunk>
+		{
+			UTL_PROFILE_SCOPE("RecordParser::parse");
+
+			const auto parts = std::max<size_t>(1, std::min(m_threads * 4, data.size() / MIN_CHUNK));
+			const auto split = detail::_split_(data.size(), parts);
+
+			// Count quotes per range to know the quote state at each range begin
+			std::vector<uint8_t> in_quote(parts + 1);
+			detail::_run_parallel_(parts, m_threads,
+								   [&](size_t i) { in_quote[i + 1] = _count_quotes_(data, split[i], split[i + 1]) & 1; });
+			for (size_t i = 1; i <= parts; ++i) in_quote[i] ^= in_quote[i - 1];
+
+			std::vector<RecordChunk> res(parts);
+			detail::_run_parallel_(parts, m_threads, [&](size_t i) {
+				if (i == 0)
+					_index_(data, 0, split[1], res[0]);
+				else if (const auto b = _find_start_(data, split[i], split[i + 1], in_quote[i]); b < split[i + 1])
+					_index_(data, b, split[i + 1], res[i]);
+			});
+
+			return res;
+		}
+
+	private:
+		static constexpr size_t MIN_CHUNK = 1U << 16;
+
+		Dialect m_dialect;
+		size_t	m_threads;
+
+		auto _count_quotes_(std::string_view data, size_t b, size_t e) const noexcept -> size_t
+		{
+			size_t res = 0;
+			for (; e - b >= 64; b += 64) res += std::popcount(detail::_match_64_(data.data() + b, m_dialect.quote));
+			return res + std::count(data.begin() + b, data.begin() + e, m_dialect.quote);
+		}
+
+		/**
+		 * @brief Find the begin of the first record starting inside of the range
+		 * @param in_quote Quote state at b
+		 * @return record begin or e if none
+		 */
+		auto _find_start_(std::string_view data, size_t b, size_t e, bool in_quote) const noexcept -> size_t
+		{
+			// A record starts at b if the previous character is an unquoted newline
+			for (auto i = b - 1; i < e; ++i)
+			{
+				if (data[i] == m_dialect.quote && i != b - 1)
+					in_quote = !in_quote;
+				else if (data[i] == '\n' && !in_quote)
+					return i + 1;
+			}
+
+			return e;
+		}
+
+		/**
+		 * @brief Index the records starting inside of [b, e). The last one may end after e.
+		 */
+		void _index_(std::string_view data, size_t b, size_t e, RecordChunk &out) const
+		{
+			size_t field = b;
+			bool   carry = false; // Quote state entering a block
+
+			auto push = [&](size_t end, bool record_end) {
+				auto f = data.substr(field, end - field);
+				if (record_end && f.ends_with('\r'))
+					f.remove_suffix(1);
+				if (f.size() >= 2 && f.front() == m_dialect.quote && f.back() == m_dialect.quote)
+					f = f.substr(1, f.size() - 2);
+
+				out.m_fields.emplace_back(f);
+				if (record_end)
+					out.m_ends.emplace_back(out.m_fields.size());
+				field = end + 1;
+			};
+
+			for (auto pos = b; pos < data.size(); pos += 64)
+			{
+				const char *block = data.data() + pos;
+				char		pad[64];
+				uint64_t	valid = ~uint64_t(0);
+
+				if (data.size() - pos < 64) // Pad the tail to a full block
+				{
+					const auto n = data.size() - pos;
+					std::memcpy(pad, block, n);
+					std::memset(pad + n, 0, 64 - n);
+					block = pad;
+					valid = (uint64_t(1) << n) - 1;
+				}
+
+				const auto quotes = detail::_match_64_(block, m_dialect.quote) & valid;
+				const auto lines  = detail::_match_64_(block, '\n') & valid;
+				const auto quoted = detail::_prefix_xor_(quotes) ^ (carry ? ~uint64_t(0) : 0);
+				carry			  = quoted >> 63;
+
+				const auto delims = detail::_match_64_(block, m_dialect.delim);
+
+				for (auto s = (delims | lines) & valid & ~quoted; s != 0; s &= s - 1)
+				{
+					const auto bit	= std::countr_zero(s);
+					const auto line = (lines >> bit) & 1;
+
+					push(pos + bit, line);
+					if (line && pos + bit + 1 >= e) // Next record belongs to the following chunk
+						return;
+				}
+			}
+
+			if (field < data.size() || (field == data.size() && field != b && data.back() != '\n'))
+				push(data.size(), true); // Last record without newline
+		}
+	};
+
+} // namespace utl
+
+#endif
@@ -0,0 +1,295 @@
+#if not defined _UTILLIB_RINGLOG_
+#define _UTILLIB_RINGLOG_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "Error.h"
+
+#if defined unix || defined __unix || defined __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Format
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Layout of a ring file: a header followed by the ring of records. Records are 8 byte aligned, never wrap
+		 * and are only valid if their hash matches, so a torn or partly overwritten record is skipped.
+		 */
+		struct _RingHeader_
+		{
+			static constexpr char MAGIC[8] = { 'U', 'T', 'L', 'R', 'I', 'N', 'G', '1' };
+			static constexpr auto SIZE	   = 64;
+
+			char	 magic[8];
+			uint64_t capacity; // Size of the ring after the header
+		};
+
+		struct _RingRecord_
+		{
+			static constexpr uint32_t MAGIC = 0x474F4C52; // "RLOG"
+
+			uint32_t magic;
+			uint32_t size; // Payload bytes
+			uint64_t seq;
+			uint64_t hash; // Of size, seq and payload
+		};
+
+		constexpr auto _ring_pad_(size_t n) noexcept -> size_t { return (n + 7) & ~size_t(7); }
+
+		inline auto _ring_hash_(uint32_t size, uint64_t seq, const char *data) noexcept -> uint64_t
+		{
+			constexpr uint64_t K = 0x9E3779B97F4A7C15ULL;
+
+			auto mix = [](uint64_t h, uint64_t v) {
+				h = (h ^ v) * K;
+				return h ^ (h >> 29);
+			};
+
+			auto h = mix(mix(K, size), seq);
+
+			size_t i = 0;
+			for (; i + 8 <= size; i += 8)
+			{
+				uint64_t v;
+				std::memcpy(&v, data + i, 8);
+				h = mix(h, v);
+			}
+
+			uint64_t v = 0;
+			std::memcpy(&v, data + i, size - i);
+			return mix(h, v);
+		}
+
+		/**
+		 * @brief Find every valid record of a ring
+		 * @return (sequence, offset) of the records, unordered
+		 */
+		inline auto _ring_scan_(const char *ring, size_t capacity) -> std::vector<std::pair<uint64_t, size_t>>
+		{
+			std::vector<std::pair<uint64_t, size_t>> res;
+
+			for (size_t off = 0; off + sizeof(_RingRecord_) <= capacity;)
+			{
+				_RingRecord_ r;
+				std::memcpy(&r, ring + off, sizeof r);
+
+				const auto body = off + sizeof r;
+				if (r.magic == _RingRecord_::MAGIC && r.size <= capacity - body
+					&& _ring_hash_(r.size, r.seq, ring + body) == r.hash)
+				{
+					res.emplace_back(r.seq, off);
+					off = body + _ring_pad_(r.size);
+				}
+				else
+					off += 8;
+			}
+
+			return res;
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Policy
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Policy writing each line as a record into a fixed size memory mapped ring file. Writing is a memcpy into a
+	 * shared mapping, so no syscalls are made and the kernel keeps the data when the process dies. Reopening the file
+	 * continues after the newest record. Use read_log_ring to get the log back.
+	 */
+	class MappedRingPolicy
+	{
+	public:
+		/**
+		 * @brief Open or create the ring file. An existing ring of another capacity is cleared.
+		 * @param path Path of the file
+		 * @param capacity Size of the ring, lines larger than a quarter of it are cut
+		 */
+		MappedRingPolicy(std::string_view path, size_t capacity)
+			: m_capacity(detail::_ring_pad_(std::max<size_t>(capacity, 256)))
+		{
+			const std::string p(path);
+			const auto		  size = detail::_RingHeader_::SIZE + m_capacity;
+
+			m_fd = ::open(p.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+			if (m_fd == -1)
+				throw std::system_error(errno, std::generic_category(), "Failed to open the log ring.");
+
+			struct stat st;
+			if (::fstat(m_fd, &st) == -1 || (size_t(st.st_size) != size && ::ftruncate(m_fd, 0) == -1)
+				|| ::ftruncate(m_fd, off_t(size)) == -1)
+			{
+				::close(m_fd);
+				throw std::system_error(errno, std::generic_category(), "Failed to size the log ring.");
+			}
+
+			auto *map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, 0);
+			if (map == MAP_FAILED)
+			{
+				::close(m_fd);
+				throw std::system_error(errno, std::generic_category(), "Failed to map the log ring.");
+			}
+
+			m_map = static_cast<char *>(map);
+
+			detail::_RingHeader_ h;
+			std::memcpy(&h, m_map, sizeof h);
+			if (std::memcmp(h.magic, detail::_RingHeader_::MAGIC, 8) != 0 || h.capacity != m_capacity)
+			{
+				std::memcpy(h.magic, detail::_RingHeader_::MAGIC, 8);
+				h.capacity = m_capacity;
+				std::memset(m_map, 0, size);
+				std::memcpy(m_map, &h, sizeof h);
+			}
+
+			// Continue after the newest record
+			const auto recs = detail::_ring_scan_(_ring_(), m_capacity);
+			if (const auto last = std::max_element(recs.begin(), recs.end()); last != recs.end())
+			{
+				detail::_RingRecord_ r;
+				std::memcpy(&r, _ring_() + last->second, sizeof r);
+				m_seq = last->first + 1;
+				m_pos = last->second + sizeof r + detail::_ring_pad_(r.size);
+			}
+		}
+
+		MappedRingPolicy(MappedRingPolicy &&o) noexcept
+			: m_capacity(o.m_capacity)
+			, m_fd(std::exchange(o.m_fd, -1))
+			, m_map(std::exchange(o.m_map, nullptr))
+			, m_pos(o.m_pos)
+			, m_seq(o.m_seq)
+			, m_pending(std::move(o.m_pending))
+		{
+		}
+
+		MappedRingPolicy(const MappedRingPolicy &) = delete;
+
+		~MappedRingPolicy()
+		{
+			if (m_map == nullptr)
+				return;
+
+			_commit_();
+			::munmap(m_map, detail::_RingHeader_::SIZE + m_capacity);
+			::close(m_fd);
+		}
+
+		/**
+		 * @brief Ignored
+		 */
+		void open() noexcept {}
+		/**
+		 * @brief Write the unfinished line
+		 */
+		void close() noexcept { _commit_(); }
+
+		/**
+		 * @brief Ask the kernel to write the ring to disk, to also survive a crash of the system
+		 */
+		void flush() noexcept { ::msync(m_map, detail::_RingHeader_::SIZE + m_capacity, MS_ASYNC); }
+
+		/**
+		 * @brief Collect the log, a record is written at the end of each line
+		 * @param msg Log to write
+		 * @param c Catagory to use (ignored)
+		 */
+		template<typename T>
+		void write(const T &msg, Catagory)
+		{
+			detail::_append_(m_pending, msg);
+			if (!m_pending.empty() && m_pending.back() == '\n')
+				_commit_();
+		}
+
+	private:
+		size_t		m_capacity;
+		int			m_fd  = -1;
+		char	   *m_map = nullptr;
+		size_t		m_pos = 0; // Next record offset in the ring
+		uint64_t	m_seq = 0;
+		std::string m_pending;
+
+		[[nodiscard]] auto _ring_() const noexcept -> char * { return m_map + detail::_RingHeader_::SIZE; }
+
+		void _commit_() noexcept
+		{
+			if (m_pending.empty())
+				return;
+
+			const auto size	 = uint32_t(std::min(m_pending.size(), m_capacity / 4));
+			const auto total = sizeof(detail::_RingRecord_) + detail::_ring_pad_(size);
+
+			if (m_pos + total > m_capacity)
+				m_pos = 0;
+
+			// Payload first, the header makes the record valid
+			auto *rec = _ring_() + m_pos;
+			std::memcpy(rec + sizeof(detail::_RingRecord_), m_pending.data(), size);
+
+			const detail::_RingRecord_ r = { .magic = detail::_RingRecord_::MAGIC,
+											 .size	= size,
+											 .seq	= m_seq,
+											 .hash	= detail::_ring_hash_(size, m_seq, m_pending.data()) };
+			std::memcpy(rec, &r, sizeof r);
+
+			m_pos += total;
+			++m_seq;
+			m_pending.clear();
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Reader
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Rebuild the log of a ring file in chronological order
+	 *
+	 * @param data Content of the ring file
+	 * @param f Callback taking each line
+	 */
+	template<typename F>
+	void read_log_ring(std::string_view data, F &&f)
+	{
+		detail::_RingHeader_ h;
+		if (data.size() < detail::_RingHeader_::SIZE)
+			throw std::runtime_error("Not a log ring.");
+
+		std::memcpy(&h, data.data(), sizeof h);
+		if (std::memcmp(h.magic, detail::_RingHeader_::MAGIC, 8) != 0
+			|| h.capacity > data.size() - detail::_RingHeader_::SIZE)
+			throw std::runtime_error("Not a log ring.");
+
+		const auto *ring = data.data() + detail::_RingHeader_::SIZE;
+		auto		recs = detail::_ring_scan_(ring, h.capacity);
+		std::sort(recs.begin(), recs.end());
+
+		for (const auto &[seq, off] : recs)
+		{
+			detail::_RingRecord_ r;
+			std::memcpy(&r, ring + off, sizeof r);
+			f(std::string_view(ring + off + sizeof r, r.size));
+		}
+	}
+
+} // namespace utl
+
+#endif
+
+#endif
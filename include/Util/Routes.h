@@ -0,0 +1,460 @@
+#if not defined _UTILLIB_ROUTES_
+#define _UTILLIB_ROUTES_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+#include "Profile.h"
+#include "Traits.h"
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Structures
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Route through a graph
+	 */
+	struct Path
+	{
+		std::vector<size_t> nodes;	// From source to target
+		std::vector<size_t> edges;	// Index of each edge in the graph, one less than nodes
+		uint32_t			weight; // Total weight
+	};
+
+	struct AlternativeOptions
+	{
+		double penalty		  = 0.5; // Weight added to an edge for each route using it, relative to its weight
+		double max_stretch	  = 1.5; // Longest accepted route relative to the shortest
+		double max_share	  = 0.8; // Largest part of a route, by weight, shared with the routes found before
+		size_t max_iterations = 0;	 // Searches to make, 0 for 4 per route
+	};
+
+	// -----------------------------------------------------------------------------
+	// Engine
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Finds several routes between two nodes. The engine keeps the reversed graph and the shortest path tree
+	 * towards the last target, so queries to the same target start without a search. The tree distances guide every
+	 * later search as an A* heuristic, which stays exact under removed or penalized edges since both only make routes
+	 * longer. Masks and penalties are arrays over the nodes and edges of the engine, the graph itself is never copied.
+	 *
+	 * @tparam T Iterator of WeighedEdge
+	 * @tparam U Iterator of size_t
+	 */
+	template<iter_matches<WeighedEdge> T, iter_matches<size_t> U>
+	class RouteEngine
+	{
+	public:
+		/**
+		 * @brief Prepare the engine, reverses the graph once
+		 * @param g Graph to search on, must outlive the engine
+		 */
+		explicit RouteEngine(const Graph<T, U> &g)
+			: m_g(g)
+			, m_ridx(g.size + 1, 0)
+			, m_redges(size_t(g.idx[g.size]))
+			, m_sources(m_redges.size())
+			, m_to_target(g.size)
+			, m_next(g.size)
+			, m_dist(g.size)
+			, m_parent(g.size)
+			, m_seen(g.size, 0)
+			, m_node_mark(g.size, 0)
+			, m_edge_mark(m_redges.size(), 0)
+			, m_hits(m_redges.size(), 0)
+		{
+			for (size_t e = 0; e < m_redges.size(); ++e) ++m_ridx[g.edges[e].dest + 1];
+			for (size_t i = 0; i < g.size; ++i) m_ridx[i + 1] += m_ridx[i];
+
+			auto pos = m_ridx;
+			for (size_t u = 0; u < g.size; ++u)
+				for (auto e = size_t(g.idx[u]); e < size_t(g.idx[u + 1]); ++e)
+				{
+					m_redges[pos[g.edges[e].dest]++] = e;
+					m_sources[e]					 = u;
+				}
+		}
+
+		/**
+		 * @brief Find the k shortest loopless paths with Yen's algorithm. Spur paths are first taken from the shortest
+		 * path tree: the best edge leaving the spur node followed by the tree is optimal whenever the tree part avoids
+		 * the root path, which spares most searches. Otherwise an A* search guided by the tree runs. Deviations of a
+		 * path only start at its own deviation node, as in Lawler's improvement.
+		 *
+		 * @param source Node to start from
+		 * @param target Node to reach
+		 * @param k Amount of paths
+		 * @return Up to k paths by increasing weight
+		 */
+		[[nodiscard]] auto k_shortest_paths(size_t source, size_t target, size_t k) -> std::vector<Path>
+		{
+			UTL_PROFILE_SCOPE("k_shortest_paths");
+
+			std::vector<Path> res;
+			if (k == 0 || !_tree_(target, source))
+				return res;
+
+			std::vector<size_t> devs = { 0 }; // Deviation node index of each path
+			res.push_back(_tree_path_(source));
+
+			using Candidate = std::pair<Path, size_t>;
+			auto worse		= [](const Candidate &a, const Candidate &b) { return a.first.weight > b.first.weight; };
+
+			std::vector<Candidate>		  cands;
+			std::set<std::vector<size_t>> known = { res.front().edges };
+
+			while (res.size() < k)
+			{
+				const auto p = res.back(); // Copy, res grows
+				uint32_t   root = 0;
+
+				for (size_t i = 0; i < devs.back(); ++i) root += _weight_(p.edges[i]);
+
+				for (auto i = devs.back(); i + 1 < p.nodes.size(); root += _weight_(p.edges[i++]))
+				{
+					const auto spur = p.nodes[i];
+
+					// Root nodes and the next edge of every found path with the same root are masked
+					_next_mark_();
+					for (size_t j = 0; j < i; ++j) m_node_mark[p.nodes[j]] = m_mark;
+					for (const auto &q : res)
+						if (q.edges.size() > i && std::equal(p.edges.begin(), p.edges.begin() + i, q.edges.begin()))
+							m_edge_mark[q.edges[i]] = m_mark;
+
+					auto spur_path = _tree_spur_(spur, target);
+					if (!spur_path && _search_<true>(spur, target, [this](size_t e) { return _weight_(e); }))
+						spur_path = _search_path_(spur, target);
+					if (!spur_path)
+						continue;
+
+					Path cand = { .nodes  = { p.nodes.begin(), p.nodes.begin() + i },
+								  .edges  = { p.edges.begin(), p.edges.begin() + i },
+								  .weight = root + spur_path->weight };
+					cand.nodes.insert(cand.nodes.end(), spur_path->nodes.begin(), spur_path->nodes.end());
+					cand.edges.insert(cand.edges.end(), spur_path->edges.begin(), spur_path->edges.end());
+
+					if (known.insert(cand.edges).second)
+					{
+						cands.emplace_back(std::move(cand), i);
+						std::push_heap(cands.begin(), cands.end(), worse);
+					}
+				}
+
+				if (cands.empty())
+					break;
+
+				std::pop_heap(cands.begin(), cands.end(), worse);
+				res.push_back(std::move(cands.back().first));
+				devs.push_back(cands.back().second);
+				cands.pop_back();
+			}
+
+			return res;
+		}
+
+		/**
+		 * @brief Find alternative routes with the penalty method. After each route its edges become more expensive and
+		 * the next search avoids them where a detour is cheap. Routes that are too long or share too much with the
+		 * routes found before are dropped. Each route costs one search guided by the shortest path tree.
+		 *
+		 * @param source Node to start from
+		 * @param target Node to reach
+		 * @param count Amount of routes, including the shortest
+		 * @param opt Limits of the accepted routes
+		 * @return Up to count routes, the shortest first
+		 */
+		[[nodiscard]] auto alternative_routes(size_t source, size_t target, size_t count,
+											  const AlternativeOptions &opt = {}) -> std::vector<Path>
+		{
+			UTL_PROFILE_SCOPE("alternative_routes");
+
+			std::vector<Path> res;
+			if (count == 0 || !_tree_(target, source))
+				return res;
+
+			res.push_back(_tree_path_(source));
+
+			// Penalties are counted per edge and cleared afterwards, edges of accepted routes carry the mark
+			std::vector<size_t> penalized;
+
+			auto penalize = [&](const Path &p) {
+				for (const auto e : p.edges)
+					if (m_hits[e]++ == 0)
+						penalized.push_back(e);
+			};
+
+			_next_mark_();
+			for (const auto e : res.front().edges) m_edge_mark[e] = m_mark;
+			penalize(res.front());
+
+			auto weight = [&](size_t e) {
+				const auto w = _weight_(e);
+				return w + uint32_t(double(w) * opt.penalty * m_hits[e]);
+			};
+
+			const auto limit = opt.max_iterations != 0 ? opt.max_iterations : 4 * count;
+			for (size_t it = 0; it < limit && res.size() < count; ++it)
+			{
+				if (!_search_<false>(source, target, weight))
+					break;
+
+				auto p = _search_path_(source, target);
+				penalize(p);
+
+				uint32_t shared = 0;
+				for (const auto e : p.edges)
+					if (m_edge_mark[e] == m_mark)
+						shared += _weight_(e);
+
+				if (double(p.weight) > opt.max_stretch * double(res.front().weight)
+					|| double(shared) > opt.max_share * double(p.weight))
+					continue;
+
+				for (const auto e : p.edges) m_edge_mark[e] = m_mark;
+				res.push_back(std::move(p));
+			}
+
+			for (const auto e : penalized) m_hits[e] = 0;
+			return res;
+		}
+
+	private:
+		static constexpr auto INF = uint32_t(-1);
+
+		Graph<T, U>			m_g;
+		std::vector<size_t> m_ridx;	  // Reversed graph, ranges of incoming edges
+		std::vector<size_t> m_redges; // Index of each incoming edge
+		std::vector<size_t> m_sources; // Source of each edge
+
+		// Shortest path tree towards m_target
+		size_t				  m_target = -1;
+		std::vector<uint32_t> m_to_target;
+		std::vector<size_t>	  m_next; // Edge towards the target
+
+		// Search state, valid where m_seen is m_search
+		std::vector<uint32_t> m_dist;
+		std::vector<size_t>	  m_parent; // Edge the node was reached by
+		std::vector<uint32_t> m_seen;
+		uint32_t			  m_search = 0;
+
+		// Masks, set where equal to m_mark
+		std::vector<uint32_t> m_node_mark;
+		std::vector<uint32_t> m_edge_mark;
+		uint32_t			  m_mark = 0;
+
+		std::vector<uint32_t> m_hits; // Penalties per edge
+
+		[[nodiscard]] auto _weight_(size_t e) const noexcept -> uint32_t { return m_g.edges[e].weight; }
+		[[nodiscard]] auto _dest_(size_t e) const noexcept -> size_t { return m_g.edges[e].dest; }
+
+		void _next_mark_() noexcept
+		{
+			if (++m_mark == 0)
+			{
+				std::fill(m_node_mark.begin(), m_node_mark.end(), 0);
+				std::fill(m_edge_mark.begin(), m_edge_mark.end(), 0);
+				m_mark = 1;
+			}
+		}
+
+		/**
+		 * @brief Build the shortest path tree towards a target, kept while the target stays the same
+		 * @return True if the source reaches the target
+		 */
+		auto _tree_(size_t target, size_t source) -> bool
+		{
+			if (m_target != target)
+			{
+				std::fill(m_to_target.begin(), m_to_target.end(), INF);
+				m_to_target[target] = 0;
+				m_next[target]		= -1;
+
+				using Entry = std::pair<uint32_t, size_t>;
+				std::priority_queue<Entry, std::vector<Entry>, std::greater<>> front;
+				front.emplace(0, target);
+
+				while (!front.empty())
+				{
+					const auto [d, v] = front.top();
+					front.pop();
+					if (d > m_to_target[v])
+						continue;
+
+					for (auto r = m_ridx[v]; r < m_ridx[v + 1]; ++r)
+					{
+						const auto e = m_redges[r];
+						const auto u = m_sources[e];
+						const auto c = d + _weight_(e);
+
+						if (c < m_to_target[u])
+						{
+							m_to_target[u] = c;
+							m_next[u]	   = e;
+							front.emplace(c, u);
+						}
+					}
+				}
+
+				m_target = target;
+			}
+
+			return m_to_target[source] != INF;
+		}
+
+		[[nodiscard]] auto _tree_path_(size_t from) const -> Path
+		{
+			Path p = { .nodes = { from }, .edges = {}, .weight = m_to_target[from] };
+			for (auto n = from; n != m_target; n = _dest_(m_next[n]))
+			{
+				p.edges.push_back(m_next[n]);
+				p.nodes.push_back(_dest_(m_next[n]));
+			}
+			return p;
+		}
+
+		/**
+		 * @brief Spur path made of the best unmasked edge leaving spur and the tree, if the tree part avoids the masked
+		 * nodes and the spur node. No other path can be shorter since the tree distances are lower bounds.
+		 */
+		[[nodiscard]] auto _tree_spur_(size_t spur, size_t target) const -> std::optional<Path>
+		{
+			if (spur == target)
+				return std::nullopt;
+
+			size_t	 best = -1;
+			uint32_t cost = INF;
+			for (auto e = size_t(m_g.idx[spur]); e < size_t(m_g.idx[spur + 1]); ++e)
+			{
+				const auto v = _dest_(e);
+				if (m_edge_mark[e] == m_mark || m_node_mark[v] == m_mark || m_to_target[v] == INF)
+					continue;
+				if (const auto c = _weight_(e) + m_to_target[v]; c < cost)
+				{
+					cost = c;
+					best = e;
+				}
+			}
+
+			if (best == size_t(-1))
+				return std::nullopt;
+
+			Path p = { .nodes = { spur, _dest_(best) }, .edges = { best }, .weight = cost };
+			for (auto n = _dest_(best); n != target; n = _dest_(m_next[n]))
+			{
+				if (n == spur || m_node_mark[n] == m_mark)
+					return std::nullopt;
+				p.edges.push_back(m_next[n]);
+				p.nodes.push_back(_dest_(m_next[n]));
+			}
+
+			return p;
+		}
+
+		/**
+		 * @brief A* search guided by the tree
+		 * @tparam Masked Skip masked nodes and edges
+		 * @param weight Weight of an edge index
+		 * @return True if the target was reached
+		 */
+		template<bool Masked, typename W>
+		auto _search_(size_t from, size_t to, W &&weight) -> bool
+		{
+			if (++m_search == 0)
+			{
+				std::fill(m_seen.begin(), m_seen.end(), 0);
+				m_search = 1;
+			}
+
+			using Entry = std::pair<uint32_t, size_t>;
+			std::priority_queue<Entry, std::vector<Entry>, std::greater<>> front;
+
+			m_seen[from]   = m_search;
+			m_dist[from]   = 0;
+			m_parent[from] = -1;
+			front.emplace(m_to_target[from], from);
+
+			while (!front.empty())
+			{
+				const auto [f, u] = front.top();
+				front.pop();
+
+				if (f > m_dist[u] + m_to_target[u]) // Outdated entry
+					continue;
+				if (u == to)
+					return true;
+
+				for (auto e = size_t(m_g.idx[u]); e < size_t(m_g.idx[u + 1]); ++e)
+				{
+					const auto v = _dest_(e);
+					if (m_to_target[v] == INF || (Masked && (m_edge_mark[e] == m_mark || m_node_mark[v] == m_mark)))
+						continue;
+
+					const auto c = m_dist[u] + weight(e);
+					if (m_seen[v] != m_search || c < m_dist[v])
+					{
+						m_seen[v]	= m_search;
+						m_dist[v]	= c;
+						m_parent[v] = e;
+						front.emplace(c + m_to_target[v], v);
+					}
+				}
+			}
+
+			return false;
+		}
+
+		/**
+		 * @brief Path of the last search, with the weights of the graph
+		 */
+		[[nodiscard]] auto _search_path_(size_t from, size_t to) const -> Path
+		{
+			Path p = { .nodes = { to }, .edges = {}, .weight = 0 };
+			for (auto n = to; n != from;)
+			{
+				const auto e = m_parent[n];
+				p.edges.push_back(e);
+				p.weight += _weight_(e);
+				n = m_sources[e];
+				p.nodes.push_back(n);
+			}
+
+			std::reverse(p.nodes.begin(), p.nodes.end());
+			std::reverse(p.edges.begin(), p.edges.end());
+			return p;
+		}
+	};
+
+	/**
+	 * @brief Find the k shortest loopless paths, see RouteEngine::k_shortest_paths
+	 */
+	template<iter_matches<WeighedEdge> T, iter_matches<size_t> U>
+	[[nodiscard]] auto k_shortest_paths(const Graph<T, U> &g, size_t source, size_t target, size_t k)
+		-> std::vector<Path>
+	{
+		return RouteEngine(g).k_shortest_paths(source, target, k);
+	}
+
+	/**
+	 * @brief Find alternative routes with the penalty method, see RouteEngine::alternative_routes
+	 */
+	template<iter_matches<WeighedEdge> T, iter_matches<size_t> U>
+	[[nodiscard]] auto alternative_routes(const Graph<T, U> &g, size_t source, size_t target, size_t count,
+										  const AlternativeOptions &opt = {}) -> std::vector<Path>
+	{
+		return RouteEngine(g).alternative_routes(source, target, count, opt);
+	}
+
+} // namespace utl
+
+#endif
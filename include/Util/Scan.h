@@ -0,0 +1,272 @@
+#if not defined _UTILLIB_SCAN_
+#define _UTILLIB_SCAN_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#if defined __x86_64__ || defined _M_X64
+#include <immintrin.h>
+#define _UTILLIB_SCAN_X86_
+#endif
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Character Set
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Set of characters used by the scanning kernels. Keeps a bitmap for the scalar path and the raw characters
+	 * for the vectorised compare.
+	 */
+	class CharSet
+	{
+	public:
+		static constexpr size_t SIMD_MAX = 16; // Sets bigger than this are scanned with the bitmap
+
+		constexpr CharSet() = default;
+
+		/**
+		 * @brief Create a set from characters
+		 * @param chars Characters contained in the set
+		 */
+		constexpr explicit CharSet(std::string_view chars) noexcept
+		{
+			for (const auto c : chars)
+			{
+				if (contains(c))
+					continue;
+
+				const auto u = static_cast<unsigned char>(c);
+				m_map[u >> 6] |= uint64_t(1) << (u & 63);
+
+				if (m_size < SIMD_MAX)
+					m_chars[m_size] = c;
+				++m_size;
+			}
+		}
+
+		/**
+		 * @brief Check if the character is part of the set
+		 * @param c Character to check
+		 * @return true Is contained
+		 * @return false Isn't contained
+		 */
+		[[nodiscard]] constexpr auto contains(char c) const noexcept -> bool
+		{
+			const auto u = static_cast<unsigned char>(c);
+			return (m_map[u >> 6] >> (u & 63)) & 1;
+		}
+
+		/**
+		 * @brief Get the amount of distinct characters
+		 * @return size
+		 */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_t { return m_size; }
+
+		/**
+		 * @brief Get the characters used by the vector kernels
+		 * @return characters, only valid up to SIMD_MAX
+		 */
+		[[nodiscard]] constexpr auto chars() const noexcept -> const char * { return m_chars.data(); }
+
+	private:
+		std::array<uint64_t, 4>	   m_map{};
+		std::array<char, SIMD_MAX> m_chars{};
+		size_t					   m_size = 0;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Kernels
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		template<bool negate>
+		constexpr auto _scan_scalar_(const char *b, const char *e, const CharSet &set) noexcept -> const char *
+		{
+			for (; b != e; ++b)
+				if (set.contains(*b) != negate)
+					return b;
+			return e;
+		}
+
+#if defined _UTILLIB_SCAN_X86_
+		inline auto _first_bit_(uint32_t mask) noexcept -> int { return __builtin_ctz(mask); }
+
+		template<bool negate>
+		auto _scan_sse2_(const char *b, const char *e, const CharSet &set) noexcept -> const char *
+		{
+			const auto n = set.size();
+
+			for (; e - b >= 16; b += 16)
+			{
+				const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+				auto	   m = _mm_setzero_si128();
+
+				for (size_t i = 0; i < n; ++i) m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(set.chars()[i])));
+
+				auto bits = static_cast<uint32_t>(_mm_movemask_epi8(m));
+				if constexpr (negate)
+					bits ^= 0xFFFF;
+
+				if (bits != 0)
+					return b + _first_bit_(bits);
+			}
+
+			return _scan_scalar_<negate>(b, e, set);
+		}
+
+#if defined __GNUC__
+		template<bool negate>
+		__attribute__((target("avx2"))) auto _scan_avx2_(const char *b, const char *e, const CharSet &set) noexcept
+			-> const char *
+		{
+			const auto n = set.size();
+
+			for (; e - b >= 32; b += 32)
+			{
+				const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+				auto	   m = _mm256_setzero_si256();
+
+				for (size_t i = 0; i < n; ++i)
+					m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(set.chars()[i])));
+
+				auto bits = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+				if constexpr (negate)
+					bits = ~bits;
+
+				if (bits != 0)
+					return b + _first_bit_(bits);
+			}
+
+			return _scan_sse2_<negate>(b, e, set);
+		}
+
+		inline auto _has_avx2_() noexcept -> bool
+		{
+			static const bool res = __builtin_cpu_supports("avx2");
+			return res;
+		}
+#endif
+#endif
+
+		/**
+		 * @brief Get a bitmask of the bytes equal to the character in a block of 64 bytes
+		 */
+		inline auto _match_64_(const char *p, char c) noexcept -> uint64_t
+		{
+#if defined _UTILLIB_SCAN_X86_
+			const auto v   = _mm_set1_epi8(c);
+			uint64_t   res = 0;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+				res |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(b, v)))) << (i * 16);
+			}
+
+			return res;
+#else
+			uint64_t res = 0;
+			for (int i = 0; i < 64; ++i) res |= uint64_t(p[i] == c) << i;
+			return res;
+#endif
+		}
+
+		/**
+		 * @brief Turn each set bit into a toggle for all following bits
+		 */
+		constexpr auto _prefix_xor_(uint64_t m) noexcept -> uint64_t
+		{
+			m ^= m << 1;
+			m ^= m << 2;
+			m ^= m << 4;
+			m ^= m << 8;
+			m ^= m << 16;
+			m ^= m << 32;
+			return m;
+		}
+
+		template<bool negate>
+		constexpr auto _scan_(const char *b, const char *e, const CharSet &set) noexcept -> const char *
+		{
+			if (std::is_constant_evaluated() || set.size() > CharSet::SIMD_MAX)
+				return _scan_scalar_<negate>(b, e, set);
+
+#if defined _UTILLIB_SCAN_X86_
+#if defined __AVX2__
+			return _scan_avx2_<negate>(b, e, set);
+#elif defined __GNUC__
+			return _has_avx2_() ? _scan_avx2_<negate>(b, e, set) : _scan_sse2_<negate>(b, e, set);
+#else
+			return _scan_sse2_<negate>(b, e, set);
+#endif
+#else
+			return _scan_scalar_<negate>(b, e, set);
+#endif
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Find the first character of the set. Uses AVX2 (32 bytes) or SSE2 (16 bytes) per step when available.
+	 * @param str String to search in
+	 * @param set Characters to search for
+	 * @param pos Position to start from
+	 * @return location or std::string_view::npos
+	 */
+	[[nodiscard]] constexpr auto find_first_of(std::string_view str, const CharSet &set, size_t pos = 0) noexcept
+		-> size_t
+	{
+		if (pos >= str.size())
+			return std::string_view::npos;
+
+		const auto e   = str.data() + str.size();
+		const auto res = detail::_scan_<false>(str.data() + pos, e, set);
+		return res == e ? std::string_view::npos : res - str.data();
+	}
+
+	/**
+	 * @brief Find the first character not part of the set. Uses AVX2 (32 bytes) or SSE2 (16 bytes) per step when
+	 * available.
+	 * @param str String to search in
+	 * @param set Characters to skip
+	 * @param pos Position to start from
+	 * @return location or std::string_view::npos
+	 */
+	[[nodiscard]] constexpr auto find_first_not_of(std::string_view str, const CharSet &set, size_t pos = 0) noexcept
+		-> size_t
+	{
+		if (pos >= str.size())
+			return std::string_view::npos;
+
+		const auto e   = str.data() + str.size();
+		const auto res = detail::_scan_<true>(str.data() + pos, e, set);
+		return res == e ? std::string_view::npos : res - str.data();
+	}
+
+	/**
+	 * @brief Find a single delimiter. Forwards to memchr which libc already dispatches to its widest vector kernel.
+	 * @param str String to search in
+	 * @param delim Character to search for
+	 * @param pos Position to start from
+	 * @return location or std::string_view::npos
+	 */
+	[[nodiscard]] constexpr auto find_char(std::string_view str, char delim, size_t pos = 0) noexcept -> size_t
+	{
+		if (std::is_constant_evaluated())
+			return str.find(delim, pos);
+
+		if (pos >= str.size())
+			return std::string_view::npos;
+
+		const auto res = std::memchr(str.data() + pos, delim, str.size() - pos);
+		return res == nullptr ? std::string_view::npos : static_cast<const char *>(res) - str.data();
+	}
+
+} // namespace utl
+
+#endif
@@ -0,0 +1,548 @@
+#if not defined _UTILLIB_SCHEDULER_
+#define _UTILLIB_SCHEDULER_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Traits.h"
+
+#if defined __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace utl
+{
+	namespace detail
+	{
+		// -----------------------------------------------------------------------------
+		// Tasks
+		// -----------------------------------------------------------------------------
+
+		struct _Task_
+		{
+			virtual ~_Task_()  = default;
+			virtual void run() = 0;
+		};
+
+		template<task F>
+		struct _FnTask_ final : _Task_
+		{
+			F f;
+
+			explicit _FnTask_(F &&f)
+				: f(std::move(f))
+			{
+			}
+
+			void run() override { f(); }
+		};
+
+		template<task F>
+		auto _make_task_(F &&f) -> _Task_ *
+		{
+			return new _FnTask_<std::decay_t<F>>(std::forward<F>(f));
+		}
+
+		// -----------------------------------------------------------------------------
+		// Chase-Lev deque
+		// -----------------------------------------------------------------------------
+
+		/**
+		 * @brief Work-stealing deque of Chase and Lev after Le et al., with the fences folded into seq_cst accesses. The
+		 * owner pushes and pops at the bottom, thieves steal from the top. Replaced arrays are kept until destruction
+		 * since a thief may still read them.
+		 */
+		class _WorkDeque_
+		{
+		public:
+			_WorkDeque_()
+				: m_array(_grow_(nullptr, 0, 0))
+			{
+			}
+
+			_WorkDeque_(const _WorkDeque_ &) = delete;
+
+			~_WorkDeque_()
+			{
+				while (auto *t = pop()) delete t;
+			}
+
+			void push(_Task_ *t)
+			{
+				const auto b = m_bottom.load(std::memory_order_relaxed);
+				const auto f = m_top.load(std::memory_order_acquire);
+				auto	  *a = m_array.load(std::memory_order_relaxed);
+
+				if (b - f > int64_t(a->mask))
+				{
+					a = _grow_(a, f, b);
+					m_array.store(a, std::memory_order_release);
+				}
+
+				a->at(b).store(t, std::memory_order_relaxed);
+				m_bottom.store(b + 1, std::memory_order_release);
+			}
+
+			auto pop() -> _Task_ *
+			{
+				const auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+				auto	  *a = m_array.load(std::memory_order_relaxed);
+				m_bottom.store(b, std::memory_order_seq_cst);
+				auto f = m_top.load(std::memory_order_seq_cst);
+
+				if (f > b)
+				{
+					m_bottom.store(b + 1, std::memory_order_relaxed);
+					return nullptr;
+				}
+
+				auto *t = a->at(b).load(std::memory_order_relaxed);
+				if (f == b)
+				{
+					// Last task, race the thieves for it
+					if (!m_top.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						t = nullptr;
+					m_bottom.store(b + 1, std::memory_order_relaxed);
+				}
+
+				return t;
+			}
+
+			auto steal() -> _Task_ *
+			{
+				auto	   f = m_top.load(std::memory_order_seq_cst);
+				const auto b = m_bottom.load(std::memory_order_seq_cst);
+
+				if (f >= b)
+					return nullptr;
+
+				auto *t = m_array.load(std::memory_order_acquire)->at(f).load(std::memory_order_relaxed);
+				if (!m_top.compare_exchange_strong(f, f + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return nullptr;
+
+				return t;
+			}
+
+			[[nodiscard]] auto empty() const noexcept -> bool
+			{
+				return m_bottom.load(std::memory_order_relaxed) <= m_top.load(std::memory_order_relaxed);
+			}
+
+		private:
+			struct _Array_
+			{
+				size_t								   mask;
+				std::unique_ptr<std::atomic<_Task_ *>[]> data;
+
+				auto at(int64_t i) noexcept -> std::atomic<_Task_ *> & { return data[size_t(i) & mask]; }
+			};
+
+			alignas(64) std::atomic<int64_t> m_top = 0;
+			alignas(64) std::atomic<int64_t> m_bottom = 0;
+			std::atomic<_Array_ *>				 m_array;
+			std::vector<std::unique_ptr<_Array_>> m_arrays; // Owner only
+
+			auto _grow_(_Array_ *old, int64_t f, int64_t b) -> _Array_ *
+			{
+				constexpr size_t INITIAL = 256;
+
+				const auto size = old == nullptr ? INITIAL : (old->mask + 1) * 2;
+				auto	  &a	= m_arrays.emplace_back(new _Array_ { size - 1, std::make_unique<std::atomic<_Task_ *>[]>(size) });
+				for (auto i = f; i < b; ++i) a->at(i).store(old->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+				return a.get();
+			}
+		};
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Scheduler
+	// -----------------------------------------------------------------------------
+
+	struct SchedulerOptions
+	{
+		size_t threads = std::thread::hardware_concurrency(); // Worker threads
+		bool   pin	   = false;								  // Pin worker i to CPU i (Linux only)
+	};
+
+	/**
+	 * @brief Work-stealing thread pool. Every worker owns a deque, tasks spawned by a worker go to its own deque and
+	 * idle workers steal from the others. Other threads submit through a shared queue and help running tasks while
+	 * they wait, so nested parallelism can't deadlock. Use instance() to share one pool within the process.
+	 */
+	class Scheduler
+	{
+	public:
+		/**
+		 * @brief Start the workers
+		 * @param opt Thread count and pinning
+		 */
+		explicit Scheduler(const SchedulerOptions &opt = {})
+			: m_workers(std::max<size_t>(opt.threads, 1))
+		{
+			m_threads.reserve(m_workers.size());
+			for (size_t i = 0; i < m_workers.size(); ++i)
+				m_threads.emplace_back([this, i, pin = opt.pin] {
+					if (pin)
+						_pin_(i);
+					_work_(i);
+				});
+		}
+
+		Scheduler(const Scheduler &) = delete;
+
+		~Scheduler()
+		{
+			m_stop.store(true);
+			_wake_(true);
+			for (auto &t : m_threads) t.join();
+
+			for (auto *t : m_injected) delete t;
+		}
+
+		/**
+		 * @brief Get the scheduler shared by the library
+		 */
+		static auto instance() -> Scheduler &
+		{
+			static Scheduler s;
+			return s;
+		}
+
+		/**
+		 * @brief Get the amount of workers
+		 */
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_workers.size(); }
+
+		/**
+		 * @brief Run a task some time later. Exceptions leaving it terminate, use a TaskGroup to get them.
+		 * @param f Task
+		 */
+		template<task F>
+		void spawn(F &&f)
+		{
+			_push_(detail::_make_task_(std::forward<F>(f)));
+		}
+
+		/**
+		 * @brief Run tasks until the predicate holds
+		 * @param done Predicate, must become true by tasks of this scheduler
+		 */
+		template<std::predicate F>
+		void help_until(F &&done)
+		{
+			while (!done())
+			{
+				if (auto *t = _find_(_self_())) [[likely]]
+				{
+					_run_(t);
+					continue;
+				}
+
+				m_idle.fetch_add(1);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const auto seen = m_signal.load();
+				if (auto *t = _find_(_self_()))
+				{
+					m_idle.fetch_sub(1);
+					_run_(t);
+					continue;
+				}
+				if (!done())
+					m_signal.wait(seen);
+				m_idle.fetch_sub(1);
+			}
+		}
+
+		/**
+		 * @brief Wake threads waiting in help_until to check their predicate
+		 */
+		void notify() noexcept { _wake_(true); }
+
+		/**
+		 * @brief Check if the calling thread is a worker of this scheduler
+		 */
+		[[nodiscard]] auto is_worker() const noexcept -> bool { return _self_() != nullptr; }
+
+		/**
+		 * @brief Check if the own deque ran empty, so splitting more work is worth it
+		 */
+		[[nodiscard]] auto hungry() const noexcept -> bool
+		{
+			const auto *w = _self_();
+			return w == nullptr ? m_injected_size.load(std::memory_order_relaxed) == 0 : w->deque.empty();
+		}
+
+	private:
+		struct alignas(64) _Worker_
+		{
+			detail::_WorkDeque_ deque;
+		};
+
+		std::vector<_Worker_>		m_workers;
+		std::vector<std::jthread>	m_threads;
+		std::mutex					m_mutex;
+		std::deque<detail::_Task_ *> m_injected;
+		std::atomic<size_t>			m_injected_size = 0;
+		std::atomic<bool>			m_stop			= false;
+		std::atomic<uint32_t>		m_idle			= 0; // Threads waiting for work
+		std::atomic<uint32_t>		m_signal		= 0; // Bumped to wake them
+
+		struct _Current_
+		{
+			const Scheduler *scheduler = nullptr;
+			_Worker_		*worker	   = nullptr;
+		};
+
+		static auto _current_() noexcept -> _Current_ &
+		{
+			thread_local _Current_ c;
+			return c;
+		}
+
+		auto _self_() const noexcept -> _Worker_ *
+		{
+			const auto &c = _current_();
+			return c.scheduler == this ? c.worker : nullptr;
+		}
+
+		void _wake_(bool always) noexcept
+		{
+			if (always || m_idle.load() != 0)
+			{
+				m_signal.fetch_add(1);
+				m_signal.notify_all();
+			}
+		}
+
+		void _push_(detail::_Task_ *t)
+		{
+			if (auto *w = _self_())
+				w->deque.push(t);
+			else
+			{
+				std::scoped_lock l(m_mutex);
+				m_injected.emplace_back(t);
+				m_injected_size.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			// Order the publish before reading m_idle, pairs with the fence in help_until
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			_wake_(false);
+		}
+
+		auto _find_(_Worker_ *self) -> detail::_Task_ *
+		{
+			if (self != nullptr)
+				if (auto *t = self->deque.pop())
+					return t;
+
+			if (m_injected_size.load(std::memory_order_relaxed) != 0)
+			{
+				std::scoped_lock l(m_mutex);
+				if (!m_injected.empty())
+				{
+					auto *t = m_injected.front();
+					m_injected.pop_front();
+					m_injected_size.fetch_sub(1, std::memory_order_relaxed);
+					return t;
+				}
+			}
+
+			// Start at a different victim per thread
+			const auto n	 = m_workers.size();
+			const auto first = (std::hash<std::thread::id>()(std::this_thread::get_id()) + m_signal.load(std::memory_order_relaxed)) % n;
+			for (size_t i = 0; i < n; ++i)
+				if (auto &v = m_workers[(first + i) % n]; &v != self)
+					if (auto *t = v.deque.steal())
+						return t;
+
+			return nullptr;
+		}
+
+		static void _run_(detail::_Task_ *t)
+		{
+			t->run();
+			delete t;
+		}
+
+		void _work_(size_t i)
+		{
+			_current_() = { this, &m_workers[i] };
+			help_until([this] { return m_stop.load(std::memory_order_relaxed); });
+		}
+
+		static void _pin_(size_t i) noexcept
+		{
+#if defined __linux__
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(i % std::max(std::thread::hardware_concurrency(), 1U), &set);
+			pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+#endif
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Fork-join
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Group of tasks to wait for. The first exception of a task is rethrown by wait.
+	 */
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup(Scheduler &s = Scheduler::instance())
+			: m_s(s)
+		{
+		}
+
+		TaskGroup(const TaskGroup &) = delete;
+
+		/**
+		 * @brief Waits for the tasks, exceptions are dropped
+		 */
+		~TaskGroup()
+		{
+			m_s.help_until([this] { return m_pending.load(std::memory_order_acquire) == 0; });
+		}
+
+		/**
+		 * @brief Run a task as part of the group
+		 * @param f Task
+		 */
+		template<task F>
+		void run(F &&f)
+		{
+			m_pending.fetch_add(1, std::memory_order_relaxed);
+			m_s.spawn([this, f = std::forward<F>(f)]() mutable {
+				if (!m_failed.load(std::memory_order_relaxed))
+					try
+					{
+						f();
+					}
+					catch (...)
+					{
+						std::scoped_lock l(m_mutex);
+						if (!m_failed.exchange(true))
+							m_exception = std::current_exception();
+					}
+
+				// The group may be gone once the count reaches zero
+				auto &s = m_s;
+				if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					s.notify();
+			});
+		}
+
+		/**
+		 * @brief Run tasks until the group is done
+		 */
+		void wait()
+		{
+			m_s.help_until([this] { return m_pending.load(std::memory_order_acquire) == 0; });
+
+			if (m_failed.load())
+			{
+				m_failed.store(false);
+				std::rethrow_exception(std::exchange(m_exception, nullptr));
+			}
+		}
+
+		/**
+		 * @brief Check if a task of the group failed, so long running tasks can stop early
+		 */
+		[[nodiscard]] auto failed() const noexcept -> bool { return m_failed.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] auto scheduler() const noexcept -> Scheduler & { return m_s; }
+
+	private:
+		Scheduler		   &m_s;
+		std::atomic<size_t> m_pending = 0;
+		std::atomic<bool>	m_failed  = false;
+		std::mutex			m_mutex;
+		std::exception_ptr	m_exception;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Loops
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Run a range in grains. The upper half is split off as a task whenever the own deque ran empty, so the
+		 * range is only divided as far as other threads are hungry for work.
+		 */
+		template<typename F>
+		void _parallel_range_(TaskGroup &g, size_t b, size_t e, size_t grain, F &f)
+		{
+			while (b < e && !g.failed())
+			{
+				if (e - b > grain && g.scheduler().hungry())
+				{
+					const auto mid = b + (e - b) / 2;
+					g.run([&g, &f, mid, e, grain] { _parallel_range_(g, mid, e, grain, f); });
+					e = mid;
+				}
+
+				const auto end = std::min(e, b + grain);
+				if constexpr (range_task<F>)
+					f(b, end);
+				else
+					for (; b < end; ++b) f(b);
+				b = end;
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Run a loop in parallel
+	 *
+	 * @param s Scheduler to use
+	 * @param b Begin of the index range
+	 * @param e End of the index range
+	 * @param f Callable taking an index or a (begin, end) subrange
+	 * @param grain Least amount of indexes run together, 0 to derive it from the range and the workers
+	 */
+	template<typename F>
+	requires index_task<F> || range_task<F>
+	void parallel_for(Scheduler &s, size_t b, size_t e, F &&f, size_t grain = 0)
+	{
+		if (b >= e)
+			return;
+
+		if (grain == 0)
+			grain = std::max<size_t>(1, (e - b) / (8 * (s.size() + 1)));
+
+		TaskGroup g(s);
+		g.run([&g, &f, b, e, grain] { detail::_parallel_range_(g, b, e, grain, f); });
+		g.wait();
+	}
+
+	/**
+	 * @brief Run a loop in parallel on the shared scheduler, see parallel_for above
+	 *
+	 * @param b Begin of the index range
+	 * @param e End of the index range
+	 * @param f Callable taking an index or a (begin, end) subrange
+	 * @param grain Least amount of indexes run together, 0 to derive it from the range and the workers
+	 */
+	template<typename F>
+	requires index_task<F> || range_task<F>
+	void parallel_for(size_t b, size_t e, F &&f, size_t grain = 0)
+	{
+		parallel_for(Scheduler::instance(), b, e, std::forward<F>(f), grain);
+	}
+
+} // namespace utl
+
+#endif
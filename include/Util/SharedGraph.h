@@ -0,0 +1,674 @@
+#if not defined _UTILLIB_SHAREDGRAPH_
+#define _UTILLIB_SHAREDGRAPH_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include <optional>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+
+#if defined unix || defined __unix || defined __unix__
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Structures
+	// -----------------------------------------------------------------------------
+
+	struct SharedGraphOptions
+	{
+		size_t partitions	  = 1;				   // Node ranges of about equal edge count
+		size_t queue_capacity = size_t(1) << 16; // Frontier messages each partition can hold
+	};
+
+	/**
+	 * @brief Node outside a partition reached by one of its edges
+	 */
+	struct GhostNode
+	{
+		size_t node;
+		size_t owner; // Partition of the node
+	};
+
+	/**
+	 * @brief Range of nodes [begin, end) and the ghost nodes its edges lead to, sorted by node
+	 */
+	struct GraphPartition
+	{
+		size_t						begin;
+		size_t						end;
+		std::span<const GhostNode> ghosts;
+	};
+
+	/**
+	 * @brief Distance update sent to the owner of a node
+	 */
+	struct FrontierMessage
+	{
+		size_t	 node;
+		size_t	 parent;
+		uint32_t dist;
+	};
+
+	namespace detail
+	{
+		// -----------------------------------------------------------------------------
+		// Segment layout
+		// -----------------------------------------------------------------------------
+
+		static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+					  "Atomics must be lock free to be shared between processes.");
+
+		/**
+		 * @brief Segment: header, queues (read-write) followed by the page aligned graph (read-only for readers).
+		 * Positions are stored as offsets since every process maps the segment elsewhere.
+		 */
+		struct _SharedGraphHeader_
+		{
+			static constexpr char MAGIC[8] = { 'U', 'T', 'L', 'S', 'G', 'R', 'F', '1' };
+
+			char					 magic[8];
+			std::atomic<uint32_t> ready; // Set by the builder when filled
+			uint32_t				 edge_size;
+			uint64_t				 nodes;
+			uint64_t				 edges;
+			uint64_t				 partitions;
+			uint64_t				 capacity; // Of each queue, a power of two
+			uint64_t				 graph_off;
+			uint64_t				 idx_off;
+			uint64_t				 edges_off;
+			uint64_t				 parts_off;
+			uint64_t				 size;
+
+			// Round barrier of the partitioned searches
+			alignas(64) std::atomic<uint32_t> arrived;
+			alignas(64) std::atomic<uint32_t> generation;
+			std::atomic<uint64_t>			 sent[2]; // Messages sent in even and odd rounds
+		};
+
+		struct _SharedPartition_
+		{
+			uint64_t begin;
+			uint64_t end;
+			uint64_t ghosts_off;
+			uint64_t ghosts;
+		};
+
+		/**
+		 * @brief Bounded multi-producer queue of Vyukov in shared memory, cells follow the header
+		 */
+		struct _SharedQueue_
+		{
+			struct Cell
+			{
+				std::atomic<uint64_t> seq;
+				FrontierMessage		  msg;
+			};
+
+			alignas(64) std::atomic<uint64_t> head; // Next cell to write
+			alignas(64) std::atomic<uint64_t> tail; // Next cell to read
+
+			auto cells() noexcept -> Cell * { return reinterpret_cast<Cell *>(this + 1); }
+
+			auto push(const FrontierMessage &m, uint64_t mask) noexcept -> bool
+			{
+				for (auto pos = head.load(std::memory_order_relaxed);;)
+				{
+					auto	  &c   = cells()[pos & mask];
+					const auto seq = c.seq.load(std::memory_order_acquire);
+
+					if (seq == pos)
+					{
+						if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						{
+							c.msg = m;
+							c.seq.store(pos + 1, std::memory_order_release);
+							return true;
+						}
+					}
+					else if (seq < pos)
+						return false; // Full
+					else
+						pos = head.load(std::memory_order_relaxed);
+				}
+			}
+
+			auto pop(uint64_t mask) noexcept -> std::optional<FrontierMessage>
+			{
+				const auto pos = tail.load(std::memory_order_relaxed);
+				auto	  &c   = cells()[pos & mask];
+
+				if (c.seq.load(std::memory_order_acquire) != pos + 1)
+					return std::nullopt;
+
+				const auto m = c.msg;
+				c.seq.store(pos + mask + 1, std::memory_order_release);
+				tail.store(pos + 1, std::memory_order_relaxed);
+				return m;
+			}
+		};
+
+		constexpr auto _align_up_(size_t n, size_t a) noexcept -> size_t { return (n + a - 1) / a * a; }
+
+		inline auto _shm_name_(std::string_view name) -> std::string
+		{
+			return name.starts_with('/') ? std::string(name) : '/' + std::string(name);
+		}
+
+		/**
+		 * @brief Wait until a shared word changes, futex without the private flag so it works across processes
+		 */
+		inline void _shared_wait_(std::atomic<uint32_t> &a, uint32_t old) noexcept
+		{
+			while (a.load(std::memory_order_acquire) == old)
+			{
+#if defined __linux__
+				::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&a), FUTEX_WAIT, old, nullptr, nullptr, 0);
+#else
+				sched_yield();
+#endif
+			}
+		}
+
+		inline void _shared_wake_(std::atomic<uint32_t> &a) noexcept
+		{
+#if defined __linux__
+			::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&a), FUTEX_WAKE, std::numeric_limits<int>::max(), nullptr,
+					  nullptr, 0);
+#else
+			(void)a;
+#endif
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Shared graph
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief CSR graph in a named POSIX shared memory segment. One process creates it, any amount of processes attach
+	 * to it and share the same physical pages. Readers map the graph read-only, only the frontier queues and the
+	 * barrier of partitioned searches are writable.
+	 *
+	 * @tparam EdgeT Edge or WeighedEdge
+	 */
+	template<same_as<Edge, WeighedEdge> EdgeT>
+	class SharedGraph
+	{
+	public:
+		/**
+		 * @brief Create the segment and copy a graph into it
+		 *
+		 * @param name Name of the segment, fails if it exists
+		 * @param g Graph to copy
+		 * @param opt Partitions and queue capacity
+		 * @return The builders view
+		 */
+		template<typename T, typename U>
+		[[nodiscard]] static auto create(std::string_view name, const Graph<T, U> &g, const SharedGraphOptions &opt = {})
+			-> SharedGraph
+		{
+			using H = detail::_SharedGraphHeader_;
+
+			const auto parts	= std::max<size_t>(opt.partitions, 1);
+			const auto capacity = std::bit_ceil(std::max<size_t>(opt.queue_capacity, 2));
+			const auto edges	= size_t(g.idx[g.size] - g.idx[0]);
+
+			// Partition bounds with about equal edge counts
+			std::vector<size_t> bounds(parts + 1, g.size);
+			bounds[0] = 0;
+			for (size_t p = 1; p < parts; ++p)
+			{
+				const auto target = g.idx[0] + edges * p / parts;
+				bounds[p] = std::max(bounds[p - 1], size_t(std::lower_bound(g.idx, g.idx + g.size, target) - g.idx));
+			}
+
+			// Ghost nodes of each partition
+			std::vector<std::vector<GhostNode>> ghosts(parts);
+			for (size_t p = 0; p < parts; ++p)
+			{
+				std::vector<size_t> out;
+				for (auto i = g.edges + g.idx[bounds[p]], e = g.edges + g.idx[bounds[p + 1]]; i != e; ++i)
+					if (i->dest < bounds[p] || i->dest >= bounds[p + 1])
+						out.emplace_back(i->dest);
+
+				std::sort(out.begin(), out.end());
+				out.erase(std::unique(out.begin(), out.end()), out.end());
+				for (const auto n : out)
+					ghosts[p].push_back(
+						{ n, size_t(std::upper_bound(bounds.begin(), bounds.end(), n) - bounds.begin()) - 1 });
+			}
+
+			// Layout
+			const auto page		 = size_t(sysconf(_SC_PAGESIZE));
+			const auto queue	 = sizeof(detail::_SharedQueue_) + capacity * sizeof(detail::_SharedQueue_::Cell);
+			const auto queue_off = detail::_align_up_(sizeof(H), 64);
+			const auto graph_off = detail::_align_up_(queue_off + parts * detail::_align_up_(queue, 64), page);
+			const auto idx_off	 = graph_off;
+			const auto edges_off = detail::_align_up_(idx_off + (g.size + 1) * sizeof(size_t), alignof(EdgeT));
+			const auto parts_off = detail::_align_up_(edges_off + edges * sizeof(EdgeT), alignof(detail::_SharedPartition_));
+
+			auto ghosts_off = parts_off + parts * sizeof(detail::_SharedPartition_);
+			auto size		= ghosts_off;
+			for (const auto &gh : ghosts) size += gh.size() * sizeof(GhostNode);
+
+			SharedGraph res;
+			res.m_name = detail::_shm_name_(name);
+
+			const auto fd = ::shm_open(res.m_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+			if (fd == -1)
+				throw std::system_error(errno, std::generic_category(), "Failed to create the shared graph.");
+
+			if (::ftruncate(fd, off_t(size)) == -1)
+			{
+				const auto err = errno;
+				::close(fd);
+				::shm_unlink(res.m_name.c_str());
+				throw std::system_error(err, std::generic_category(), "Failed to size the shared graph.");
+			}
+
+			auto *map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (map == MAP_FAILED)
+			{
+				const auto err = errno;
+				::shm_unlink(res.m_name.c_str());
+				throw std::system_error(err, std::generic_category(), "Failed to map the shared graph.");
+			}
+
+			res.m_rw	  = static_cast<char *>(map);
+			res.m_rw_size = size;
+			res.m_ro	  = res.m_rw + graph_off;
+			res.m_ro_size = 0; // Part of the read-write mapping
+
+			auto *h = new (res.m_rw) H {};
+			std::memcpy(h->magic, H::MAGIC, sizeof h->magic);
+			h->edge_size  = sizeof(EdgeT);
+			h->nodes	  = g.size;
+			h->edges	  = edges;
+			h->partitions = parts;
+			h->capacity	  = capacity;
+			h->graph_off  = graph_off;
+			h->idx_off	  = idx_off;
+			h->edges_off  = edges_off;
+			h->parts_off  = parts_off;
+			h->size		  = size;
+
+			for (size_t p = 0; p < parts; ++p)
+			{
+				auto *q = new (res.m_rw + queue_off + p * detail::_align_up_(queue, 64)) detail::_SharedQueue_ {};
+				for (size_t i = 0; i < capacity; ++i) new (q->cells() + i) detail::_SharedQueue_::Cell { { i }, {} };
+			}
+
+			auto *idx = reinterpret_cast<size_t *>(res.m_rw + idx_off);
+			for (size_t i = 0; i <= g.size; ++i) idx[i] = g.idx[i] - g.idx[0];
+			std::copy(g.edges + g.idx[0], g.edges + g.idx[g.size], reinterpret_cast<EdgeT *>(res.m_rw + edges_off));
+
+			auto *part = reinterpret_cast<detail::_SharedPartition_ *>(res.m_rw + parts_off);
+			for (size_t p = 0; p < parts; ++p)
+			{
+				part[p] = { bounds[p], bounds[p + 1], ghosts_off, ghosts[p].size() };
+				std::copy(ghosts[p].begin(), ghosts[p].end(), reinterpret_cast<GhostNode *>(res.m_rw + ghosts_off));
+				ghosts_off += ghosts[p].size() * sizeof(GhostNode);
+			}
+
+			res._setup_(queue_off, detail::_align_up_(queue, 64));
+			h->ready.store(1, std::memory_order_release);
+			return res;
+		}
+
+		/**
+		 * @brief Attach to a segment created by another process
+		 * @param name Name of the segment
+		 * @return The readers view
+		 */
+		[[nodiscard]] static auto attach(std::string_view name) -> SharedGraph
+		{
+			using H = detail::_SharedGraphHeader_;
+
+			SharedGraph res;
+			res.m_name = detail::_shm_name_(name);
+
+			const auto fd = ::shm_open(res.m_name.c_str(), O_RDWR | O_CLOEXEC, 0);
+			if (fd == -1)
+				throw std::system_error(errno, std::generic_category(), "Failed to open the shared graph.");
+
+			struct stat st;
+			if (::fstat(fd, &st) == -1 || size_t(st.st_size) < sizeof(H))
+			{
+				::close(fd);
+				throw std::runtime_error("Not a shared graph.");
+			}
+
+			H h;
+			if (::pread(fd, static_cast<void *>(&h), sizeof h, 0) != sizeof h || std::memcmp(h.magic, H::MAGIC, 8) != 0
+				|| h.size != size_t(st.st_size) || h.ready.load() == 0)
+			{
+				::close(fd);
+				throw std::runtime_error("Not a ready shared graph.");
+			}
+			if (h.edge_size != sizeof(EdgeT))
+			{
+				::close(fd);
+				throw std::invalid_argument("Shared graph has another edge type.");
+			}
+
+			auto *rw = ::mmap(nullptr, h.graph_off, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			auto *ro = ::mmap(nullptr, h.size - h.graph_off, PROT_READ, MAP_SHARED, fd, off_t(h.graph_off));
+			const auto err = errno;
+			::close(fd);
+
+			if (rw == MAP_FAILED || ro == MAP_FAILED)
+			{
+				if (rw != MAP_FAILED)
+					::munmap(rw, h.graph_off);
+				if (ro != MAP_FAILED)
+					::munmap(ro, h.size - h.graph_off);
+				throw std::system_error(err, std::generic_category(), "Failed to map the shared graph.");
+			}
+
+			res.m_rw	  = static_cast<char *>(rw);
+			res.m_rw_size = h.graph_off;
+			res.m_ro	  = static_cast<char *>(ro);
+			res.m_ro_size = h.size - h.graph_off;
+
+			const auto queue = sizeof(detail::_SharedQueue_) + h.capacity * sizeof(detail::_SharedQueue_::Cell);
+			res._setup_(detail::_align_up_(sizeof(H), 64), detail::_align_up_(queue, 64));
+			return res;
+		}
+
+		/**
+		 * @brief Remove the name of a segment, attached processes keep their mapping
+		 * @param name Name of the segment
+		 */
+		static void remove(std::string_view name) noexcept { ::shm_unlink(detail::_shm_name_(name).c_str()); }
+
+		SharedGraph(SharedGraph &&o) noexcept
+			: m_name(std::move(o.m_name))
+			, m_rw(std::exchange(o.m_rw, nullptr))
+			, m_ro(std::exchange(o.m_ro, nullptr))
+			, m_rw_size(o.m_rw_size)
+			, m_ro_size(o.m_ro_size)
+			, m_queue_off(o.m_queue_off)
+			, m_queue_stride(o.m_queue_stride)
+		{
+		}
+
+		SharedGraph(const SharedGraph &) = delete;
+
+		~SharedGraph()
+		{
+			if (m_rw == nullptr)
+				return;
+
+			::munmap(m_rw, m_rw_size);
+			if (m_ro_size != 0)
+				::munmap(m_ro, m_ro_size);
+		}
+
+		/**
+		 * @brief Get a view usable by the graph algorithms
+		 * @return Graph
+		 */
+		[[nodiscard]] auto graph() const noexcept -> Graph<const EdgeT *, const size_t *>
+		{
+			return { .edges = reinterpret_cast<const EdgeT *>(_graph_(_header_().edges_off)),
+					 .idx	= reinterpret_cast<const size_t *>(_graph_(_header_().idx_off)),
+					 .size	= _header_().nodes };
+		}
+
+		/**
+		 * @brief Get the amount of partitions
+		 */
+		[[nodiscard]] auto partitions() const noexcept -> size_t { return _header_().partitions; }
+
+		/**
+		 * @brief Get a partition
+		 * @param p Index of the partition
+		 * @return Node range and ghost nodes
+		 */
+		[[nodiscard]] auto partition(size_t p) const noexcept -> GraphPartition
+		{
+			const auto &s = reinterpret_cast<const detail::_SharedPartition_ *>(_graph_(_header_().parts_off))[p];
+			return { .begin	 = s.begin,
+					 .end	 = s.end,
+					 .ghosts = { reinterpret_cast<const GhostNode *>(_graph_(s.ghosts_off)), s.ghosts } };
+		}
+
+		/**
+		 * @brief Get the partition of a node
+		 */
+		[[nodiscard]] auto owner(size_t node) const noexcept -> size_t
+		{
+			size_t l = 0, r = partitions();
+			while (r - l > 1)
+			{
+				const auto m = (l + r) / 2;
+				(partition(m).begin <= node ? l : r) = m;
+			}
+			return l;
+		}
+
+		/**
+		 * @brief Send a message to the queue of a partition, from any process
+		 * @return False if the queue is full
+		 */
+		auto push(size_t p, const FrontierMessage &m) noexcept -> bool { return _queue_(p).push(m, _header_().capacity - 1); }
+
+		/**
+		 * @brief Take a message from the queue of a partition, only by the process owning it
+		 */
+		auto pop(size_t p) noexcept -> std::optional<FrontierMessage> { return _queue_(p).pop(_header_().capacity - 1); }
+
+		/**
+		 * @brief Wait until every partition arrived, the processes of a partitioned search call this once per round
+		 *
+		 * @param round Round number, counted from 0 by every process
+		 * @param sent Messages the caller sent this round
+		 * @return Messages all partitions sent this round
+		 */
+		auto barrier(size_t round, uint64_t sent) noexcept -> uint64_t
+		{
+			auto &h = _header_();
+			h.sent[round % 2].fetch_add(sent);
+
+			const auto gen = h.generation.load(std::memory_order_acquire);
+			if (h.arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == h.partitions)
+			{
+				// Every process read the other counter after the previous round, clear it for the next
+				h.arrived.store(0, std::memory_order_relaxed);
+				h.sent[(round + 1) % 2].store(0);
+				h.generation.fetch_add(1, std::memory_order_release);
+				detail::_shared_wake_(h.generation);
+			}
+			else
+				detail::_shared_wait_(h.generation, gen);
+
+			return h.sent[round % 2].load();
+		}
+
+	private:
+		std::string m_name;
+		char	   *m_rw	  = nullptr; // Header and queues, for the builder the whole segment
+		char	   *m_ro	  = nullptr; // Graph
+		size_t		m_rw_size = 0;
+		size_t		m_ro_size = 0; // 0 if part of the read-write mapping
+		size_t		m_queue_off;
+		size_t		m_queue_stride;
+
+		SharedGraph() = default;
+
+		void _setup_(size_t queue_off, size_t stride) noexcept
+		{
+			m_queue_off	   = queue_off;
+			m_queue_stride = stride;
+		}
+
+		[[nodiscard]] auto _header_() const noexcept -> detail::_SharedGraphHeader_ &
+		{
+			return *std::launder(reinterpret_cast<detail::_SharedGraphHeader_ *>(m_rw));
+		}
+
+		[[nodiscard]] auto _graph_(size_t off) const noexcept -> const char * { return m_ro + (off - _header_().graph_off); }
+
+		[[nodiscard]] auto _queue_(size_t p) const noexcept -> detail::_SharedQueue_ &
+		{
+			return *std::launder(reinterpret_cast<detail::_SharedQueue_ *>(m_rw + m_queue_off + p * m_queue_stride));
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Partitioned search
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Result of a partitioned search for the nodes of one partition
+	 */
+	struct PartitionPaths
+	{
+		size_t				  begin;  // First node of the partition
+		std::vector<uint32_t> dist;	  // Distance of node begin + i, -1 if unreached
+		std::vector<size_t>	  parent; // Previous node on the path, -1 if unreached
+	};
+
+	/**
+	 * @brief Shortest paths from a source, split over one process per partition. Rounds alternate between a local
+	 * Dijkstra over the own nodes and sending improved distances of ghost nodes to their owners. The search ends after
+	 * a round in which no partition sent anything. Edge weights are 1 for Edge, which gives a breadth first search.
+	 * Every partition has to run it with the same source at the same time.
+	 *
+	 * @param g Shared graph
+	 * @param p Partition of the calling process
+	 * @param source Node to start from
+	 * @return Distances and parents of the own nodes
+	 */
+	template<typename EdgeT>
+	[[nodiscard]] auto partitioned_shortest_paths(SharedGraph<EdgeT> &g, size_t p, size_t source) -> PartitionPaths
+	{
+		constexpr auto INF = uint32_t(-1);
+
+		const auto view = g.graph();
+		const auto part = g.partition(p);
+		const auto n	= part.end - part.begin;
+
+		PartitionPaths res = { .begin = part.begin, .dist = std::vector<uint32_t>(n, INF), .parent = std::vector<size_t>(n, -1) };
+
+		std::vector<uint32_t> ghost_dist(part.ghosts.size(), INF); // Best distance sent to each ghost
+		std::vector<size_t>	  ghost_parent(part.ghosts.size());
+		std::vector<size_t>	  ghost_round(part.ghosts.size(), 0); // Last round + 1 a ghost was improved in
+		std::vector<size_t>	  touched;							   // Ghosts improved this round
+
+		using Entry = std::pair<uint32_t, size_t>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<>> front;
+
+		auto receive = [&](const FrontierMessage &m) {
+			if (const auto l = m.node - part.begin; m.dist < res.dist[l])
+			{
+				res.dist[l]	  = m.dist;
+				res.parent[l] = m.parent;
+				front.emplace(m.dist, m.node);
+			}
+		};
+
+		if (source >= part.begin && source < part.end)
+			receive({ .node = source, .parent = source, .dist = 0 });
+
+		for (size_t round = 0;; ++round)
+		{
+			while (const auto m = g.pop(p)) receive(*m);
+
+			// Local Dijkstra, remote improvements are collected per ghost
+			while (!front.empty())
+			{
+				const auto [d, u] = front.top();
+				front.pop();
+				if (d > res.dist[u - part.begin])
+					continue;
+
+				for (auto i = view.edges + view.idx[u], e = view.edges + view.idx[u + 1]; i != e; ++i)
+				{
+					uint32_t w = 1;
+					if constexpr (std::is_same_v<EdgeT, WeighedEdge>)
+						w = i->weight;
+
+					const auto v  = i->dest;
+					const auto nd = d + w;
+
+					if (v >= part.begin && v < part.end)
+					{
+						if (nd < res.dist[v - part.begin])
+						{
+							res.dist[v - part.begin]   = nd;
+							res.parent[v - part.begin] = u;
+							front.emplace(nd, v);
+						}
+					}
+					else
+					{
+						const auto gi = size_t(std::lower_bound(part.ghosts.begin(), part.ghosts.end(), v,
+																[](const GhostNode &a, size_t b) { return a.node < b; })
+											   - part.ghosts.begin());
+						if (nd < ghost_dist[gi])
+						{
+							if (std::exchange(ghost_round[gi], round + 1) != round + 1)
+								touched.push_back(gi);
+							ghost_dist[gi]	 = nd;
+							ghost_parent[gi] = u;
+						}
+					}
+				}
+			}
+
+			// Send, updates for full queues wait for the next round so no process blocks another
+			std::vector<size_t> pending;
+			for (const auto gi : touched)
+			{
+				const FrontierMessage m = { .node = part.ghosts[gi].node, .parent = ghost_parent[gi], .dist = ghost_dist[gi] };
+				if (!g.push(part.ghosts[gi].owner, m))
+				{
+					ghost_round[gi] = round + 2;
+					pending.push_back(gi);
+				}
+			}
+
+			// Pending updates keep the search going as well
+			const auto sent = touched.size();
+			touched			= std::move(pending);
+
+			if (g.barrier(round, sent) == 0)
+				break;
+		}
+
+		return res;
+	}
+
+} // namespace utl
+
+#endif
+
+#endif
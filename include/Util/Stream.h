@@ -0,0 +1,272 @@
+#if not defined _UTILLIB_STREAM_
+#define _UTILLIB_STREAM_
+
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "Parse.h"
+
+namespace utl
+{
+	/**
+	 * @brief Parser reading from a file descriptor through a fixed window. Uses a buffer of twice the window size: data
+	 * is read into the free half and only an unfinished token is moved to the front once the free space runs out.
+	 * Returned strings point into the buffer and stay valid until the next call on the parser.
+	 */
+	class StreamParser
+	{
+	public:
+		static constexpr size_t DEFAULT_WINDOW = 1U << 16;
+
+		/**
+		 * @brief Initialize the parser with a descriptor. The descriptor isn't owned.
+		 * @param fd File descriptor to read from, like a file or pipe
+		 * @param window Largest token size and read granularity
+		 */
+		explicit StreamParser(int fd, size_t window = DEFAULT_WINDOW)
+			: m_fd(fd)
+			, m_window(window)
+			, m_buf(std::make_unique<char[]>(window * 2))
+		{
+		}
+
+		/**
+		 * @brief Get the string until the delimiter is found. Moves the start ptr to the delimiter
+		 * @param delim Character to get till
+		 * @return string or null object when delim not found before the end of the stream
+		 */
+		auto get_until(char delim) -> std::optional<std::string_view>
+		{
+			return _get_till_([delim](std::string_view s, size_t from) { return find_char(s, delim, from); });
+		}
+
+		/**
+		 * @brief Get the string until any of the delimiters is found. Moves the start ptr to the delimiter
+		 * @param delims Characters to get till
+		 * @return string or null object when none of the delims is found before the end of the stream
+		 */
+		auto get_until(const CharSet &delims) -> std::optional<std::string_view>
+		{
+			return _get_till_([&delims](std::string_view s, size_t from) { return find_first_of(s, delims, from); });
+		}
+
+		/**
+		 * @brief Skip until the delimiter is found. Moves to the end of the stream when not found.
+		 * @param delim delimiter to skip to
+		 */
+		void skip_till(char delim)
+		{
+			_skip_pending_();
+
+			for (;;)
+			{
+				if (const auto loc = find_char(_view_(), delim, m_loc); loc != std::string_view::npos)
+				{
+					m_loc = loc + 1;
+					return;
+				}
+
+				m_loc = m_end;
+				if (!_refill_())
+					return;
+			}
+		}
+
+		/**
+		 * @brief Skip whitespace characters. Including '\n', '\t', ' '.
+		 */
+		void skip_space()
+		{
+			m_skip_space = false;
+
+			for (;;)
+			{
+				if (const auto loc = find_first_not_of(_view_(), SPACES, m_loc); loc != std::string_view::npos)
+				{
+					m_loc = loc;
+					return;
+				}
+
+				m_loc = m_end;
+				if (!_refill_())
+					return;
+			}
+		}
+
+		/**
+		 * @brief Extract a string until whitespace character.
+		 * @return string until whitespace or end
+		 */
+		auto take() -> std::string_view
+		{
+			const auto loc = _scan_([](std::string_view s, size_t from) { return find_first_of(s, SPACES, from); });
+			const auto end = loc == std::string_view::npos ? m_end : loc;
+			const auto res = std::string_view(m_buf.get() + m_loc, end - m_loc);
+			m_loc		   = end;
+
+			return res;
+		}
+
+		/**
+		 * @brief Extract a string until whitespace character. Whitespace at end skipped to next word. Unlike take the
+		 * result is kept in place while skipping the following whitespace.
+		 * @return string until whitespace or end
+		 */
+		auto extract() -> std::string_view
+		{
+			const auto v = take();
+
+			// Skip the whitespace inside the buffer only, refilling would move the token
+			if (const auto loc = find_first_not_of(_view_(), SPACES, m_loc); loc != std::string_view::npos)
+				m_loc = loc;
+			else
+			{
+				m_loc		 = m_end;
+				m_skip_space = true;
+			}
+
+			return v;
+		}
+
+		/**
+		 * @brief Get the current character
+		 * @return current character, '\0' at the end
+		 */
+		auto current() -> char { return at_end() ? '\0' : m_buf[m_loc]; }
+
+		/**
+		 * @brief Get the current character and move 1 up
+		 * @return current character, '\0' at the end
+		 */
+		auto get() -> char
+		{
+			if (at_end())
+				return '\0';
+
+			return m_buf[m_loc++];
+		}
+
+		/**
+		 * @brief Get the next available non whitespace character and move 1 up
+		 * @return next character
+		 */
+		auto next() -> char
+		{
+			skip_space();
+			return get();
+		}
+
+		/**
+		 * @brief Check if the stream is exhausted. Reads more data when the window is empty.
+		 * @return true Is at the end
+		 * @return false Isn't at the end
+		 */
+		auto at_end() -> bool
+		{
+			_skip_pending_();
+
+			return m_loc == m_end && !_refill_();
+		}
+
+		/**
+		 * @brief Get the amount of bytes consumed from the descriptor
+		 * @return The amount
+		 */
+		[[nodiscard]] auto current_loc() const noexcept -> size_t { return m_offset + m_loc; }
+
+		/**
+		 * @brief Get the window size
+		 * @return The size
+		 */
+		[[nodiscard]] auto window() const noexcept -> size_t { return m_window; }
+
+	private:
+		static constexpr const CharSet &SPACES = SequentialParser::WHITESPACE_SET;
+
+		int						m_fd;
+		size_t					m_window;
+		std::unique_ptr<char[]> m_buf;
+
+		size_t m_loc		= 0U;	 // Parse position inside buffer
+		size_t m_end		= 0U;	 // End of the read data
+		size_t m_offset		= 0U;	 // Stream position of the buffer begin
+		bool   m_eof		= false;
+		bool   m_skip_space = false; // Pending skip from extract
+
+		void _skip_pending_()
+		{
+			if (m_skip_space)
+				skip_space();
+		}
+
+		[[nodiscard]] auto _view_() const noexcept -> std::string_view { return { m_buf.get(), m_end }; }
+
+		auto _refill_() -> bool
+		{
+			if (m_eof)
+				return false;
+
+			if (m_window * 2 - m_end < m_window) // Second half used, move the unfinished token to the front
+			{
+				const auto keep = m_end - m_loc;
+				if (keep >= m_window)
+					throw std::length_error("Token exceeds the stream window.");
+
+				std::memmove(m_buf.get(), m_buf.get() + m_loc, keep);
+				m_offset += m_loc;
+				m_loc = 0U;
+				m_end = keep;
+			}
+
+			ssize_t n;
+			while ((n = ::read(m_fd, m_buf.get() + m_end, m_window * 2 - m_end)) < 0)
+				if (errno != EINTR)
+					throw std::system_error(errno, std::generic_category(), "Failed to read from stream.");
+
+			m_end += n;
+			m_eof = n == 0;
+
+			return !m_eof;
+		}
+
+		template<typename F>
+		auto _scan_(F find) -> size_t
+		{
+			_skip_pending_();
+
+			for (size_t from = m_loc;;)
+			{
+				if (const auto loc = find(_view_(), from); loc != std::string_view::npos)
+					return loc;
+
+				const auto scanned = m_end - m_loc; // Rescanning after a refill starts at the new data
+				if (!_refill_())
+					return std::string_view::npos;
+				from = m_loc + scanned;
+			}
+		}
+
+		template<typename F>
+		auto _get_till_(F find) -> std::optional<std::string_view>
+		{
+			if (const auto loc = _scan_(find); loc != std::string_view::npos)
+			{
+				const auto res = std::string_view(m_buf.get() + m_loc, loc - m_loc);
+				m_loc		   = loc;
+				return res;
+			}
+
+			return std::nullopt;
+		}
+	};
+
+} // namespace utl
+
+#endif
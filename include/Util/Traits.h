@@ -1,6 +1,8 @@
 #if not defined _UTILLIB_TRAITS_
 #define _UTILLIB_TRAITS_
 
+#include <concepts>
+#include <cstddef>
 #include <iterator>
 #include <type_traits>
 #include <utility>
@@ -84,6 +86,24 @@ namespace utl
 	template<typename T, typename... U>
 	concept iter_matches = std::disjunction_v<std::is_same<typename std::iterator_traits<T>::value_type, U>...>;
 
+	/**
+	 * @brief Is callable without arguments, like a task of a Scheduler
+	 */
+	template<typename F>
+	concept task = std::invocable<std::decay_t<F> &>;
+
+	/**
+	 * @brief Is callable with an index
+	 */
+	template<typename F>
+	concept index_task = std::invocable<std::decay_t<F> &, std::size_t>;
+
+	/**
+	 * @brief Is callable with a (begin, end) range of indexes
+	 */
+	template<typename F>
+	concept range_task = std::invocable<std::decay_t<F> &, std::size_t, std::size_t>;
+
 	/**
 	 * @brief Strip type of pointer, reference, const and volatile
 	 */
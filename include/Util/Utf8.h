@@ -0,0 +1,573 @@
+#if not defined _UTILLIB_UTF8_
+#define _UTILLIB_UTF8_
+
+#include <array>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#include "Parse.h"
+
+namespace utl
+{
+	// -----------------------------------------------------------------------------
+	// Validation
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Get the length of a valid code point starting at b
+		 * @return length or 0 if invalid or cut off
+		 */
+		constexpr auto _utf8_length_(const char *b, const char *e) noexcept -> size_t
+		{
+			const auto c0 = static_cast<unsigned char>(b[0]);
+			if (c0 < 0x80)
+				return 1;
+
+			size_t		  n;
+			unsigned char lo = 0x80, hi = 0xBF; // Allowed range of the second byte
+
+			if (c0 >= 0xC2 && c0 <= 0xDF)
+				n = 2;
+			else if (c0 >= 0xE0 && c0 <= 0xEF)
+			{
+				n  = 3;
+				lo = c0 == 0xE0 ? 0xA0 : 0x80; // Overlong
+				hi = c0 == 0xED ? 0x9F : 0xBF; // Surrogates
+			}
+			else if (c0 >= 0xF0 && c0 <= 0xF4)
+			{
+				n  = 4;
+				lo = c0 == 0xF0 ? 0x90 : 0x80; // Overlong
+				hi = c0 == 0xF4 ? 0x8F : 0xBF; // Above U+10FFFF
+			}
+			else
+				return 0;
+
+			if (e - b < (ptrdiff_t)n)
+				return 0;
+
+			if (const auto c1 = static_cast<unsigned char>(b[1]); c1 < lo || c1 > hi)
+				return 0;
+
+			for (size_t i = 2; i < n; ++i)
+				if ((static_cast<unsigned char>(b[i]) & 0xC0) != 0x80)
+					return 0;
+
+			return n;
+		}
+
+		/**
+		 * @brief Decode a code point of known valid length
+		 */
+		constexpr auto _utf8_decode_(const char *b, size_t n) noexcept -> char32_t
+		{
+			constexpr unsigned char lead_mask[] = { 0, 0x7F, 0x1F, 0x0F, 0x07 };
+
+			char32_t res = static_cast<unsigned char>(b[0]) & lead_mask[n];
+			for (size_t i = 1; i < n; ++i) res = (res << 6) | (static_cast<unsigned char>(b[i]) & 0x3F);
+			return res;
+		}
+
+		/**
+		 * @brief Encode a code point
+		 * @return length written to out, 0 if not encodable
+		 */
+		constexpr auto _utf8_encode_(char32_t c, char (&out)[4]) noexcept -> size_t
+		{
+			if (c < 0x80)
+			{
+				out[0] = static_cast<char>(c);
+				return 1;
+			}
+			if (c < 0x800)
+			{
+				out[0] = static_cast<char>(0xC0 | (c >> 6));
+				out[1] = static_cast<char>(0x80 | (c & 0x3F));
+				return 2;
+			}
+			if (c < 0x10000)
+			{
+				if (c >= 0xD800 && c <= 0xDFFF)
+					return 0;
+
+				out[0] = static_cast<char>(0xE0 | (c >> 12));
+				out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+				out[2] = static_cast<char>(0x80 | (c & 0x3F));
+				return 3;
+			}
+			if (c < 0x110000)
+			{
+				out[0] = static_cast<char>(0xF0 | (c >> 18));
+				out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+				out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+				out[3] = static_cast<char>(0x80 | (c & 0x3F));
+				return 4;
+			}
+
+			return 0;
+		}
+
+#if defined _UTILLIB_SCAN_X86_ && defined __GNUC__
+		/**
+		 * @brief Lookup table validation of 32 bytes as described by Keiser and Lemire. Each byte pair is classified by
+		 * three nibble lookups whose intersection holds the error bits, the remaining continuation counts are checked
+		 * through the bytes 2 and 3 positions back.
+		 */
+		struct _Utf8Avx2_
+		{
+			static constexpr uint8_t TOO_SHORT		= 1 << 0;
+			static constexpr uint8_t TOO_LONG		= 1 << 1;
+			static constexpr uint8_t OVERLONG_3		= 1 << 2;
+			static constexpr uint8_t TOO_LARGE		= 1 << 3;
+			static constexpr uint8_t SURROGATE		= 1 << 4;
+			static constexpr uint8_t OVERLONG_2		= 1 << 5;
+			static constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+			static constexpr uint8_t OVERLONG_4		= 1 << 6;
+			static constexpr uint8_t TWO_CONTS		= 1 << 7;
+			static constexpr uint8_t CARRY			= TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+			__attribute__((target("avx2"))) static auto _lookup_(__m256i idx, const uint8_t (&t)[16]) noexcept
+				-> __m256i
+			{
+				const auto table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(t)));
+				return _mm256_shuffle_epi8(table, idx);
+			}
+
+			__attribute__((target("avx2"))) static auto _high_(__m256i v) noexcept -> __m256i
+			{
+				return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+			}
+
+			/**
+			 * @brief Check a block against the end of the previous one, which is replaced by the block
+			 * @return true if no error was found
+			 */
+			__attribute__((target("avx2"))) static auto _check_(const char *block, uint8_t (&prev)[32],
+																  bool &incomplete) noexcept -> bool
+			{
+				static constexpr uint8_t byte_1_high[16] = {
+					TOO_LONG, // 0_______ ASCII
+					TOO_LONG,
+					TOO_LONG,
+					TOO_LONG,
+					TOO_LONG,
+					TOO_LONG,
+					TOO_LONG,
+					TOO_LONG,
+					TWO_CONTS, // 10______ continuation
+					TWO_CONTS,
+					TWO_CONTS,
+					TWO_CONTS,
+					TOO_SHORT | OVERLONG_2,							   // 1100____ two byte lead
+					TOO_SHORT,										   // 1101____ two byte lead
+					TOO_SHORT | OVERLONG_3 | SURROGATE,				   // 1110____ three byte lead
+					TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4 // 1111____ four byte lead
+				};
+				static constexpr uint8_t byte_1_low[16] = {
+					CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+					CARRY | OVERLONG_2,
+					CARRY,
+					CARRY,
+					CARRY | TOO_LARGE,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+					CARRY | TOO_LARGE | TOO_LARGE_1000,
+					CARRY | TOO_LARGE | TOO_LARGE_1000
+				};
+				static constexpr uint8_t byte_2_high[16] = {
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+					TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+					TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+					TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT,
+					TOO_SHORT
+				};
+				static constexpr uint8_t max_value[32] = { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+														   255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+														   255, 255, 255, 255, 255, 255, 255, 0xEF, 0xDF, 0xBF };
+
+				const auto input = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+				const auto last	 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(prev));
+
+				if (_mm256_movemask_epi8(input) == 0) // ASCII, only an unfinished sequence before is an error
+					return !incomplete;
+
+				// Input shifted by n bytes with the end of the previous block shifted in
+				const auto carried = _mm256_permute2x128_si256(last, input, 0x21);
+				const auto prev1   = _mm256_alignr_epi8(input, carried, 16 - 1);
+				const auto prev2   = _mm256_alignr_epi8(input, carried, 16 - 2);
+				const auto prev3   = _mm256_alignr_epi8(input, carried, 16 - 3);
+
+				const auto special = _mm256_and_si256(
+					_mm256_and_si256(_lookup_(_high_(prev1), byte_1_high),
+									 _lookup_(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)), byte_1_low)),
+					_lookup_(_high_(input), byte_2_high));
+
+				const auto third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8(char(0xE0 - 0x80)));
+				const auto fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(char(0xF0 - 0x80)));
+				const auto must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80)));
+				const auto error  = _mm256_xor_si256(must23, special);
+
+				const auto max = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(max_value));
+				incomplete	   = !_mm256_testz_si256(_mm256_subs_epu8(input, max), _mm256_subs_epu8(input, max));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(prev), input);
+
+				return _mm256_testz_si256(error, error);
+			}
+		};
+#endif
+	} // namespace detail
+
+	/**
+	 * @brief Incremental UTF-8 validator. Data is fed in blocks of 32 bytes, checked with lookup tables through AVX2
+	 * when available, otherwise code point by code point.
+	 */
+	class Utf8Validator
+	{
+	public:
+		static constexpr size_t BLOCK = 32;
+
+		Utf8Validator() noexcept
+#if defined _UTILLIB_SCAN_X86_ && defined __GNUC__
+			: m_simd(detail::_has_avx2_())
+#endif
+		{
+		}
+
+		/**
+		 * @brief Validate the next block
+		 * @param block Ptr to BLOCK bytes
+		 * @return true Valid so far
+		 * @return false Invalid
+		 */
+		auto feed(const char *block) noexcept -> bool
+		{
+			if (!m_valid)
+				return false;
+
+#if defined _UTILLIB_SCAN_X86_ && defined __GNUC__
+			if (m_simd)
+				return m_valid = detail::_Utf8Avx2_::_check_(block, m_prev, m_incomplete);
+#endif
+
+			auto b = block;
+
+			if (m_pending != 0) // Complete the code point cut off by the previous block
+			{
+				auto cp = reinterpret_cast<char *>(m_prev);
+				std::memcpy(cp + m_pending, block, 4 - m_pending);
+
+				const auto n = detail::_utf8_length_(cp, cp + 4);
+				if (n <= m_pending)
+					return m_valid = false;
+
+				b += n - m_pending;
+				m_pending = 0;
+			}
+
+			for (const auto e = block + BLOCK; b < e;)
+			{
+				if (static_cast<unsigned char>(*b) < 0x80)
+					++b;
+				else if (const auto n = detail::_utf8_length_(b, e); n != 0)
+					b += n;
+				else if (e - b < (ptrdiff_t)_expected_(*b)) // Continued in the next block
+				{
+					m_pending = e - b;
+					std::memcpy(m_prev, b, m_pending);
+					break;
+				}
+				else
+					return m_valid = false;
+			}
+
+			return true;
+		}
+
+		/**
+		 * @brief Validate the last bytes of the input
+		 * @param b Begin of the remaining bytes
+		 * @param n Amount, at most BLOCK
+		 * @return true Input is valid
+		 * @return false Input is invalid
+		 */
+		auto finish(const char *b, size_t n) noexcept -> bool
+		{
+			char block[BLOCK] = {}; // Zero padding makes any unfinished code point an error
+			std::memcpy(block, b, n);
+
+			if (!feed(block))
+				return false;
+
+			if (const char empty[BLOCK] = {}; n == BLOCK) // No padding left, check the end with an empty block
+				return feed(empty);
+
+			return true;
+		}
+
+		/**
+		 * @brief Check if everything fed so far is valid
+		 */
+		[[nodiscard]] auto valid() const noexcept -> bool { return m_valid; }
+
+	private:
+		bool	m_valid		   = true;
+		bool	m_simd		   = false;
+		bool	m_incomplete   = false; // Last block ends inside a code point (vector path)
+		size_t	m_pending	   = 0;		// Bytes of a cut off code point (scalar path)
+		uint8_t m_prev[BLOCK] = {};
+
+		/**
+		 * @brief Get the sequence length announced by a lead byte
+		 */
+		static constexpr auto _expected_(char lead) noexcept -> size_t
+		{
+			const auto c = static_cast<unsigned char>(lead);
+			return c >= 0xC2 && c <= 0xDF ? 2 : c >= 0xE0 && c <= 0xEF ? 3 : c >= 0xF0 && c <= 0xF4 ? 4 : 0;
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Parser
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Parser working on code points. Validation is fused into scanning: whenever a search passes the validated
+	 * part, the next 32 byte block is validated and then searched while still in cache. Once an invalid block is met
+	 * every operation fails.
+	 */
+	class Utf8Parser
+	{
+	public:
+		Utf8Parser() = default;
+
+		/**
+		 * @brief Initialize the Parser with a string
+		 * @param String to parse
+		 */
+		explicit Utf8Parser(std::string_view dat) { data(dat); }
+
+		/**
+		 * @brief Change parsed string and reset
+		 * @param dat New string to use
+		 */
+		void data(std::string_view dat)
+		{
+			m_p.data(dat);
+			m_str		= dat;
+			m_validator = Utf8Validator();
+			m_valid_to	= 0U;
+		}
+
+		/**
+		 * @brief Get the string until the code point is found. Moves the start ptr to the delimiter
+		 * @param delim Code point to get till
+		 * @return string or null object when delim not found or the input is invalid
+		 */
+		auto get_until(char32_t delim) -> std::optional<std::string_view>
+		{
+			char	   enc[4];
+			const auto n = detail::_utf8_encode_(delim, enc);
+			if (n == 0)
+				return std::nullopt;
+
+			const auto needle = std::string_view(enc, n);
+
+			// A lead byte never appears inside of another code point
+			const auto loc = _scan_([this, needle](size_t b, size_t e) {
+				for (auto i = b; (i = find_char(m_str.substr(0, e), needle[0], i)) != std::string_view::npos; ++i)
+					if (m_str.substr(i, needle.size()) == needle)
+						return i;
+				return std::string_view::npos;
+			});
+
+			if (loc == std::string_view::npos)
+				return std::nullopt;
+
+			return m_p.get_until((ptrdiff_t)(loc - m_p.current_loc()));
+		}
+
+		/**
+		 * @brief Extract a string until whitespace character.
+		 * @return string until whitespace or end, null object if the input is invalid
+		 */
+		auto take() -> std::optional<std::string_view>
+		{
+			const auto loc = _scan_([this](size_t b, size_t e) {
+				return find_first_of(m_str.substr(0, e), SequentialParser::WHITESPACE_SET, b);
+			});
+
+			if (!m_validator.valid())
+				return std::nullopt;
+
+			const auto end = loc == std::string_view::npos ? m_str.size() : loc;
+			return m_p.get_until((ptrdiff_t)(end - m_p.current_loc()));
+		}
+
+		/**
+		 * @brief Get a number of code points
+		 * @param count Maximum amount of code points
+		 * @return string of count code points or less at the end, null object if the input is invalid
+		 */
+		auto take(size_t count) -> std::optional<std::string_view>
+		{
+			auto i = m_p.current_loc();
+
+			for (; count != 0 && i < m_str.size(); --count)
+			{
+				const auto n = detail::_utf8_length_(m_str.data() + i, m_str.data() + m_str.size());
+				if (n == 0)
+					return std::nullopt;
+				i += n;
+			}
+
+			return m_p.get_until((ptrdiff_t)(i - m_p.current_loc()));
+		}
+
+		/**
+		 * @brief Skip whitespace characters. Including '\n', '\t', ' '.
+		 */
+		void skip_space() { m_p.skip_space(); }
+
+		/**
+		 * @brief Get the current code point without going ahead
+		 * @return code point, null object at the end or on an invalid sequence
+		 */
+		[[nodiscard]] auto peek() const noexcept -> std::optional<char32_t>
+		{
+			const auto n = _length_();
+			return n == 0 ? std::nullopt : std::optional(detail::_utf8_decode_(m_str.data() + m_p.current_loc(), n));
+		}
+
+		/**
+		 * @brief Get the current code point and move past it
+		 * @return code point, null object at the end or on an invalid sequence
+		 */
+		auto get() noexcept -> std::optional<char32_t>
+		{
+			const auto n = _length_();
+			if (n == 0)
+				return std::nullopt;
+
+			const auto res = detail::_utf8_decode_(m_str.data() + m_p.current_loc(), n);
+			m_p.skip_for(n);
+			return res;
+		}
+
+		/**
+		 * @brief Check if parser is at the end
+		 */
+		[[nodiscard]] auto at_end() const noexcept -> bool { return m_p.at_end(); }
+
+		/**
+		 * @brief Check if no invalid UTF-8 was met while scanning
+		 */
+		[[nodiscard]] auto valid() const noexcept -> bool { return m_validator.valid(); }
+
+		/**
+		 * @brief Get the current string ptr position in bytes
+		 */
+		[[nodiscard]] auto current_loc() const noexcept -> size_t { return m_p.current_loc(); }
+
+		/**
+		 * @brief Peek the remaining characters
+		 */
+		[[nodiscard]] auto rest() const noexcept -> std::string_view { return m_p.rest(); }
+
+	private:
+		SequentialParser m_p;
+		std::string_view m_str;
+		Utf8Validator	 m_validator;
+		size_t			 m_valid_to = 0U; // Bytes validated so far, a multiple of the block size until the end
+
+		/**
+		 * @brief Get the length of the current code point, 0 at the end or on an invalid sequence
+		 */
+		[[nodiscard]] auto _length_() const noexcept -> size_t
+		{
+			if (m_p.at_end())
+				return 0;
+			return detail::_utf8_length_(m_str.data() + m_p.current_loc(), m_str.data() + m_str.size());
+		}
+
+		/**
+		 * @brief Search from the current location, validating new blocks before they are searched
+		 * @param find Callable searching [b, e) returning the location or npos
+		 * @return location or npos if not found or invalid
+		 */
+		template<typename F>
+		auto _scan_(F find) -> size_t
+		{
+			auto b = m_p.current_loc();
+
+			if (b < m_valid_to) // Already validated part
+			{
+				if (const auto res = find(b, m_valid_to); res != std::string_view::npos)
+					return res;
+				b = m_valid_to;
+			}
+
+			while (m_valid_to < m_str.size())
+			{
+				const auto block = m_str.data() + m_valid_to;
+				const auto n	 = std::min(Utf8Validator::BLOCK, m_str.size() - m_valid_to);
+
+				const auto last = m_valid_to + n == m_str.size();
+				if (!(last ? m_validator.finish(block, n) : m_validator.feed(block)))
+					return std::string_view::npos;
+
+				m_valid_to += n;
+
+				if (m_valid_to > b)
+				{
+					if (const auto res = find(std::max(b, m_valid_to - n), m_valid_to); res != std::string_view::npos)
+						return res;
+					b = m_valid_to;
+				}
+			}
+
+			return std::string_view::npos;
+		}
+	};
+
+	/**
+	 * @brief Check if the string is valid UTF-8
+	 * @param str String to check
+	 * @return true Is valid
+	 * @return false Isn't valid
+	 */
+	[[nodiscard]] inline auto validate_utf8(std::string_view str) noexcept -> bool
+	{
+		Utf8Validator v;
+
+		auto b = str.data();
+		for (const auto e = b + str.size(); e - b >= (ptrdiff_t)Utf8Validator::BLOCK; b += Utf8Validator::BLOCK)
+			if (!v.feed(b))
+				return false;
+
+		return v.finish(b, str.data() + str.size() - b);
+	}
+
+} // namespace utl
+
+#endif
@@ -2,6 +2,9 @@
 #include <Util/Commandline.h>
 #include <Util/Error.h>
 
+#include <filesystem>
+#include <fstream>
+
 TEST(Commandline, Basic)
 {
 	const char *ar[] = { "./exec", "-aabcAss", "Bruh", "--ass", "ABC" };
@@ -27,6 +30,124 @@ TEST(Commandline, Basic)
 	ASSERT_EQ(ass, "ABC");
 }
 
+enum class Mode
+{
+	FAST,
+	SAFE,
+};
+
+constexpr auto enum_names(Mode) noexcept
+{
+	return std::array { std::pair { std::string_view("fast"), Mode::FAST }, std::pair { std::string_view("safe"), Mode::SAFE } };
+}
+
+static constexpr utl::ArgNames<2, 3, 1, 2> typed_args { .optional_names		 = { "mode", "timeout", "ratio" },
+														.optional_short_names = { 'j' },
+														.flag_names			 = { 'v', 'q' } };
+
+TEST(Commandline, Typed)
+{
+	const char *ar[] = { "./exec", "in.txt", "-vvj8", "--timeout", "1500ms", "--mode", "safe", "--ratio", "0.5", "-7" };
+
+	std::string_view		  in;
+	int						  n = 0;
+	Mode					  mode {};
+	std::chrono::seconds	  timeout {};
+	double					  ratio = 0;
+	unsigned				  jobs	= 0;
+	uint32_t				  v = 0, q = 0;
+
+	utl::bind_args<typed_args>(10, ar,
+							   { .required_values		= { in, n },
+								 .optional_values		= { mode, timeout, ratio },
+								 .optional_short_values = { jobs },
+								 .flag_values			= { &v, &q } });
+
+	EXPECT_EQ(in, "in.txt");
+	EXPECT_EQ(in.data(), ar[1]);
+	EXPECT_EQ(n, -7);
+	EXPECT_EQ(mode, Mode::SAFE);
+	EXPECT_EQ(timeout, std::chrono::seconds(1));
+	EXPECT_EQ(ratio, 0.5);
+	EXPECT_EQ(jobs, 8);
+	EXPECT_EQ(v, 2);
+	EXPECT_EQ(q, 0);
+
+	const char *bad_value[] = { "./exec", "a", "1", "--mode", "slow" };
+	EXPECT_THROW(utl::bind_args<typed_args>(5, bad_value,
+											{ .required_values		 = { in, n },
+											  .optional_values		 = { mode, timeout, ratio },
+											  .optional_short_values = { jobs },
+											  .flag_values			 = { &v, &q } }),
+				 std::invalid_argument);
+
+	const char *bad_name[] = { "./exec", "a", "1", "--modes", "fast" };
+	EXPECT_THROW(utl::bind_args<typed_args>(5, bad_name,
+											{ .required_values		 = { in, n },
+											  .optional_values		 = { mode, timeout, ratio },
+											  .optional_short_values = { jobs },
+											  .flag_values			 = { &v, &q } }),
+				 std::logic_error);
+}
+
+static auto temp_file(std::string_view name, std::string_view content) -> std::string
+{
+	const auto path = (std::filesystem::temp_directory_path() / name).string();
+	std::ofstream(path, std::ios::binary) << content;
+	return path;
+}
+
+static constexpr utl::ArgNames<1, 1, 0, 2> list_args { .optional_names		 = { "mode" },
+													   .optional_short_names = {},
+													   .flag_names			 = { 'v', 'q' } };
+
+TEST(Commandline, Response_File)
+{
+	std::string list;
+	for (size_t i = 0; i < 100000; ++i) list += "dir/file" + std::to_string(i) + (i % 7 == 0 ? "\n" : " ");
+
+	const auto nested = "@" + temp_file("utl_args_nested.rsp", list);
+	const auto outer  = "@" + temp_file("utl_args.rsp", "--mode safe\n\"with space.txt\" -v " + nested + " last");
+
+	const char		   *ar[] = { "./exec", "first", outer.c_str(), "-q" };
+	const utl::ArgList l(4, ar);
+	EXPECT_EQ(l.size(), 100007);
+
+	std::string_view			  first;
+	Mode						  mode {};
+	uint32_t					  v = 0, q = 0;
+	std::vector<std::string_view> paths;
+
+	utl::bind_args<list_args>(
+		l, { .required_values = { first }, .optional_values = { mode }, .optional_short_values = {}, .flag_values = { &v, &q } },
+		[&](std::string_view p) { paths.emplace_back(p); });
+
+	EXPECT_EQ(first, "first");
+	EXPECT_EQ(mode, Mode::SAFE);
+	EXPECT_EQ(v, 1);
+	EXPECT_EQ(q, 1);
+	ASSERT_EQ(paths.size(), 100002);
+	EXPECT_EQ(paths[0], "with space.txt");
+	EXPECT_EQ(paths[1], "dir/file0");
+	EXPECT_EQ(paths[100000], "dir/file99999");
+	EXPECT_EQ(paths[100001], "last");
+
+	std::string required;
+	size_t		extra = 0;
+	utl::arg_to_data(l, utl::Arguments<1, 1, 0, 2> { .optional_names		  = { "mode" },
+													 .optional_short_names  = {},
+													 .flag_names			  = { 'v', 'q' },
+													 .required_values		  = { &required },
+													 .optional_values		  = { &required },
+													 .optional_short_values = {},
+													 .flag_values			  = { &v, &q } },
+					 [&](std::string_view) { ++extra; });
+	EXPECT_EQ(extra, 100002);
+
+	const char *missing[] = { "./exec", "@/nonexistent/utl_args.rsp" };
+	EXPECT_THROW(utl::ArgList(2, missing), std::system_error);
+}
+
 auto main(int argc, char **argv) -> int
 {
 	testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,348 @@
+#include <gtest/gtest.h>
+#include <Util/BinaryLog.h>
+#include <Util/Error.h>
+#include <Util/FileSystem.h>
+#include <Util/RingLog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+/**
+ * @brief Policy writing into a shared string. Waits while the gate is closed.
+ */
+class MemoryPolicy
+{
+public:
+	explicit MemoryPolicy(std::shared_ptr<std::string> out, std::shared_ptr<std::atomic<bool>> gate = nullptr)
+		: m_out(std::move(out))
+		, m_gate(std::move(gate))
+	{
+	}
+
+	void open() noexcept {}
+	void close() noexcept {}
+
+	template<typename T>
+	void write(const T &msg, utl::Catagory)
+	{
+		if (m_gate)
+			m_gate->wait(false);
+		utl::detail::_append_(*m_out, msg);
+	}
+
+private:
+	std::shared_ptr<std::string>	   m_out;
+	std::shared_ptr<std::atomic<bool>> m_gate;
+};
+
+static auto lines(const std::string &str) -> size_t { return std::count(str.begin(), str.end(), '\n'); }
+
+static auto read_file(const std::string &path) -> std::string
+{
+	std::ostringstream os;
+	os << std::ifstream(path, std::ios::binary).rdbuf();
+	return os.str();
+}
+
+// -----------------------------------------------------------------------------
+// Logger
+// -----------------------------------------------------------------------------
+
+TEST(Logger, Timestamp)
+{
+	using namespace std::chrono;
+
+	utl::TimestampFormatter f;
+	const auto				t = sys_days(2024y / 2 / 29) + 23h + 59min + 59s;
+
+	EXPECT_EQ(f.format(t + 5us), "2024-02-29 23:59:59.000005 ");
+	EXPECT_EQ(f.format(t + 999999us), "2024-02-29 23:59:59.999999 ");
+	EXPECT_EQ(f.format(t + 1s + 120us), "2024-03-01 00:00:00.000120 ");
+	EXPECT_EQ(f.format(sys_days(1969y / 12 / 31) + 23h + 59min + 59s + 500ms), "1969-12-31 23:59:59.500000 ");
+}
+
+TEST(Logger, Severity)
+{
+	auto out = std::make_shared<std::string>();
+
+	utl::Logger<MemoryPolicy> log(MemoryPolicy { out });
+	UTL_LOG(log, utl::Catagory::ERR) << "code " << 7;
+	log.write(utl::Catagory::INFO, "plain");
+
+	static_assert(utl::LOG_MIN_SEVERITY == utl::Catagory::INFO);
+	ASSERT_EQ(lines(*out), 2);
+	EXPECT_EQ(out->substr(utl::TimestampFormatter::SIZE, 16), "[ERROR] code 7\n2");
+}
+
+// -----------------------------------------------------------------------------
+// AsyncLogger
+// -----------------------------------------------------------------------------
+
+TEST(AsyncLogger, Format)
+{
+	auto out = std::make_shared<std::string>();
+
+	{
+		utl::AsyncLogger<MemoryPolicy> log(16, utl::AsyncLogger<MemoryPolicy>::BLOCK, MemoryPolicy(out));
+		log.write(utl::Catagory::WARN) << "value " << 42 << ' ' << 1.5;
+		log.write(utl::Catagory::ERR, "plain");
+		log.flush();
+
+		ASSERT_EQ(lines(*out), 2);
+		EXPECT_EQ(out->substr(27, 20), "[WARN] value 42 1.5\n");
+		EXPECT_TRUE(out->ends_with(" [ERROR] plain\n"));
+		log.seperate();
+	}
+
+	EXPECT_TRUE(out->ends_with("----\n\n"));
+}
+
+TEST(AsyncLogger, Nested)
+{
+	auto out = std::make_shared<std::string>();
+
+	utl::AsyncLogger<MemoryPolicy> log(16, utl::AsyncLogger<MemoryPolicy>::BLOCK, MemoryPolicy(out));
+
+	// Logging while building another record keeps both intact
+	auto helper = [&log] {
+		log.write(utl::Catagory::INFO) << "inner";
+		return 7;
+	};
+	log.write(utl::Catagory::WARN) << "outer-a " << helper() << " outer-b";
+	log.flush();
+
+	ASSERT_EQ(lines(*out), 2);
+	EXPECT_NE(out->find(" [INFO] inner\n"), std::string::npos);
+	EXPECT_NE(out->find(" [WARN] outer-a 7 outer-b\n"), std::string::npos);
+}
+
+TEST(AsyncLogger, Concurrent_Block)
+{
+	constexpr size_t THREADS = 4, RECORDS = 20000;
+
+	auto out = std::make_shared<std::string>();
+	utl::AsyncLogger<MemoryPolicy> log(64, utl::AsyncLogger<MemoryPolicy>::BLOCK, MemoryPolicy(out));
+
+	{
+		std::vector<std::jthread> pool;
+		for (size_t t = 0; t < THREADS; ++t)
+			pool.emplace_back([&log, t] {
+				for (size_t i = 0; i < RECORDS; ++i) log.write(utl::Catagory::INFO) << t << ':' << i;
+			});
+	}
+
+	log.flush();
+	EXPECT_EQ(lines(*out), THREADS * RECORDS);
+	EXPECT_NE(out->find("3:19999\n"), std::string::npos);
+	EXPECT_EQ(log.dropped(), 0);
+}
+
+TEST(AsyncLogger, Drop_Count)
+{
+	auto out  = std::make_shared<std::string>();
+	auto gate = std::make_shared<std::atomic<bool>>(false);
+	utl::AsyncLogger<MemoryPolicy> log(8, utl::AsyncLogger<MemoryPolicy>::DROP_COUNT, MemoryPolicy(out, gate));
+
+	for (size_t i = 0; i < 20; ++i) log.write(utl::Catagory::INFO, "record");
+	EXPECT_GE(log.dropped(), 11);
+
+	gate->store(true);
+	gate->notify_all();
+	log.flush();
+
+	EXPECT_EQ(lines(*out), 20 - log.dropped() + 1);
+	EXPECT_NE(out->find("[WARN] Dropped " + std::to_string(log.dropped()) + " log records."), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// FilePolicy
+// -----------------------------------------------------------------------------
+
+TEST(FilePolicy, Buffered)
+{
+	const auto path = (std::filesystem::temp_directory_path() / "utl_log_buffered.log").string();
+
+	utl::AsyncLogger<utl::FilePolicy> log(
+		64, utl::AsyncLogger<utl::FilePolicy>::BLOCK,
+		utl::FilePolicy(path, { .interval = std::chrono::hours(1), .durability = utl::FilePolicy::DATA }));
+
+	for (size_t i = 0; i < 1000; ++i) log.write(utl::Catagory::INFO) << "line " << i;
+	log.write(utl::Catagory::INFO, std::string(100000, 'x')); // Larger than the buffer
+	log.flush();
+
+	const auto content = read_file(path);
+	EXPECT_EQ(lines(content), 1001);
+	EXPECT_NE(content.find("[INFO] line 999\n"), std::string::npos);
+}
+
+TEST(FilePolicy, Rotate)
+{
+	const auto path = (std::filesystem::temp_directory_path() / "utl_log_rotate.log").string();
+	for (size_t i = 1; i <= 3; ++i) std::filesystem::remove(path + '.' + std::to_string(i));
+
+	{
+		utl::Logger<utl::FilePolicy> log(utl::FilePolicy(path, { .max_size = 200, .max_files = 2 }));
+		for (size_t i = 0; i < 40; ++i) log.write(utl::Catagory::INFO, "record " + std::to_string(i));
+	}
+
+	EXPECT_TRUE(std::filesystem::exists(path + ".1"));
+	EXPECT_TRUE(std::filesystem::exists(path + ".2"));
+	EXPECT_FALSE(std::filesystem::exists(path + ".3"));
+
+	// Files are cut at record boundaries, the newest records are in the current file
+	for (const auto &p : { path, path + ".1", path + ".2" })
+	{
+		const auto content = read_file(p);
+		EXPECT_TRUE(content.empty() || content.ends_with('\n')) << p;
+		EXPECT_LE(content.size(), 200 + 40) << p;
+	}
+	EXPECT_NE(read_file(path + ".1").find("record 3"), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// MappedRingPolicy
+// -----------------------------------------------------------------------------
+
+static auto read_ring(const std::string &path) -> std::vector<std::string>
+{
+	const utl::MappedFile	 file(path.c_str());
+	std::vector<std::string> res;
+	utl::read_log_ring(file.view(), [&](std::string_view l) { res.emplace_back(l); });
+	return res;
+}
+
+TEST(MappedRingPolicy, Crash)
+{
+	const auto path = (std::filesystem::temp_directory_path() / "utl_log.ring").string();
+	std::filesystem::remove(path);
+
+	// The child dies without unmapping or closing anything
+	if (const auto pid = fork(); pid == 0)
+	{
+		auto *log = new utl::Logger<utl::MappedRingPolicy>(utl::MappedRingPolicy(path, 4096));
+		for (size_t i = 0; i < 1000; ++i) log->write(utl::Catagory::INFO, "record " + std::to_string(i));
+		_exit(0);
+	}
+	else
+	{
+		int status;
+		waitpid(pid, &status, 0);
+	}
+
+	auto res = read_ring(path);
+	ASSERT_GT(res.size(), 50);
+	ASSERT_LT(res.size(), 1000);
+	for (size_t i = 0; i < res.size(); ++i)
+		EXPECT_TRUE(res[i].ends_with(" [INFO] record " + std::to_string(1000 - res.size() + i) + "\n")) << res[i];
+
+	// Reopening continues after the newest record
+	{
+		utl::Logger<utl::MappedRingPolicy> log(utl::MappedRingPolicy(path, 4096));
+		log.write(utl::Catagory::WARN, "after");
+	}
+
+	res = read_ring(path);
+	EXPECT_TRUE(res[res.size() - 2].ends_with(" record 999\n"));
+	EXPECT_TRUE(res.back().ends_with(" [WARN] after\n"));
+}
+
+// -----------------------------------------------------------------------------
+// BinaryLogger
+// -----------------------------------------------------------------------------
+
+enum class Color : uint8_t
+{
+	RED = 3,
+};
+
+TEST(BinaryLogger, Decode)
+{
+	constexpr size_t THREADS = 4, RECORDS = 10000;
+
+	const auto path = (std::filesystem::temp_directory_path() / "utl_log.blog").string();
+
+	{
+		utl::BinaryLogger log(path, 4096); // Small staging ring to wrap often
+
+		UTL_BLOG(log, utl::Catagory::WARN, "ints {} {} float {} str {} {} char {} bool {} enum {}", -42, uint64_t(-1),
+				 0.25, "literal", std::string("owned"), 'x', false, Color::RED);
+		log.flush();
+
+		std::vector<std::jthread> pool;
+		for (size_t t = 0; t < THREADS; ++t)
+			pool.emplace_back([&log, t] {
+				for (size_t i = 0; i < RECORDS; ++i) UTL_BLOG(log, utl::Catagory::INFO, "thread {} record {}", t, i);
+			});
+	}
+
+	const utl::MappedFile	 file(path.c_str());
+	std::vector<std::string> res;
+	utl::decode_binary_log(file.view(), [&](std::string_view l) { res.emplace_back(l); });
+
+	ASSERT_EQ(res.size(), THREADS * RECORDS + 1);
+	EXPECT_EQ(res[0].substr(27), "[WARN] ints -42 18446744073709551615 float 0.25 str literal owned char x bool false enum 3\n");
+	EXPECT_NE(std::find_if(res.begin(), res.end(), [](const auto &l) { return l.ends_with(" [INFO] thread 3 record 9999\n"); }),
+			  res.end());
+
+	EXPECT_THROW(utl::decode_binary_log(file.view().substr(0, file.size() - 1), [](std::string_view) {}),
+				 std::runtime_error);
+}
+
+TEST(BinaryLogger, ShortLivedThreads)
+{
+	const auto path = (std::filesystem::temp_directory_path() / "utl_log_threads.blog").string();
+
+	{
+		utl::BinaryLogger log(path, 4096);
+
+		for (size_t t = 0; t < 100; ++t)
+		{
+			std::jthread([&log, &path, t] {
+				UTL_BLOG(log, utl::Catagory::INFO, "thread {}", t);
+
+				// Loggers destroyed while the thread runs are pruned from its cache
+				for (size_t i = 0; i < 3; ++i)
+				{
+					utl::BinaryLogger other(path + ".other", 4096);
+					UTL_BLOG(other, utl::Catagory::INFO, "other {}", i);
+				}
+			}).join();
+
+			log.flush();
+			EXPECT_EQ(log.staging_rings(), 0);
+		}
+
+		UTL_BLOG(log, utl::Catagory::INFO, "main");
+		log.flush();
+		EXPECT_EQ(log.staging_rings(), 1);
+	}
+
+	const utl::MappedFile	 file(path.c_str());
+	std::vector<std::string> res;
+	utl::decode_binary_log(file.view(), [&](std::string_view l) { res.emplace_back(l); });
+
+	ASSERT_EQ(res.size(), 101);
+	EXPECT_TRUE(res[99].ends_with(" [INFO] thread 99\n"));
+
+	std::filesystem::remove(path);
+	std::filesystem::remove(path + ".other");
+}
+
+auto main(int argc, char **argv) -> int
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <Util/FileSystem.h>
+#include <Util/Parse.h>
+
+#include <fstream>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Data
+// -----------------------------------------------------------------------------
+
+static auto temp_file(std::string_view name, std::string_view content) -> std::string
+{
+	const auto path = (std::filesystem::temp_directory_path() / name).string();
+	std::ofstream(path, std::ios::binary) << content;
+	return path;
+}
+
+/**
+ * @brief Tree of 4 levels with 4 directories and 8 files of i bytes in each directory
+ */
+static auto temp_tree(std::string_view name) -> std::string
+{
+	const auto root = std::filesystem::temp_directory_path() / name;
+	std::filesystem::remove_all(root);
+
+	auto fill = [](auto &self, const std::filesystem::path &dir, size_t level) -> void {
+		std::filesystem::create_directories(dir);
+		for (size_t i = 0; i < 8; ++i) std::ofstream(dir / ("file" + std::to_string(i))) << std::string(i, 'x');
+		if (level < 4)
+			for (size_t i = 0; i < 4; ++i) self(self, dir / ("dir" + std::to_string(i)), level + 1);
+	};
+	fill(fill, root, 1);
+	std::filesystem::create_directory_symlink(root / "dir0", root / "link");
+
+	return root.string();
+}
+
+// -----------------------------------------------------------------------------
+// Tests
+// -----------------------------------------------------------------------------
+
+TEST(MappedFile, Parse)
+{
+	const auto		path = temp_file("utl_mapped.txt", "first second\nthird");
+	utl::MappedFile file(path.c_str(), utl::MappedFile::SEQUENTIAL | utl::MappedFile::WILLNEED);
+
+	utl::SequentialParser p;
+	p.data(file);
+
+	EXPECT_EQ(file.size(), 18);
+	EXPECT_EQ(p.extract(), "first");
+	EXPECT_EQ(p.extract(), "second");
+	EXPECT_EQ(p.extract(), "third");
+	EXPECT_TRUE(p.at_end());
+}
+
+TEST(MappedFile, Huge_Page)
+{
+	const std::string content(5000, 'x');
+	const auto		  path = temp_file("utl_mapped_huge.txt", content);
+
+	utl::MappedFile file(path.c_str(), utl::MappedFile::HUGEPAGE);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(file.data()) % (1U << 21), 0);
+	EXPECT_EQ(file.view(), content);
+
+	utl::MappedFile moved = std::move(file);
+	EXPECT_TRUE(file.empty());
+	EXPECT_EQ(moved.view(), content);
+}
+
+TEST(MappedFile, Empty)
+{
+	const auto		path = temp_file("utl_mapped_empty.txt", "");
+	utl::MappedFile file(path.c_str());
+
+	EXPECT_TRUE(file.empty());
+	EXPECT_EQ(file.data(), nullptr);
+	EXPECT_EQ(utl::SequentialParser(file).extract(), "");
+}
+
+TEST(MappedFile, Missing)
+{
+	EXPECT_THROW(utl::MappedFile("/nonexistent/utl_mapped"), std::system_error);
+}
+
+TEST(Walk, Tree)
+{
+	const auto root = temp_tree("utl_walk");
+
+	std::set<std::string> expected;
+	for (const auto &e : std::filesystem::recursive_directory_iterator(root)) expected.emplace(e.path().string());
+
+	for (const size_t threads : { 1, 4 })
+	{
+		std::mutex			  mutex;
+		std::set<std::string> found;
+		size_t				  links = 0, bytes = 0;
+
+		const auto errors =
+			utl::walk_directory(root, { .threads = threads, .stat_mask = STATX_SIZE }, [&](const utl::DirEntry &e) {
+				std::scoped_lock l(mutex);
+				found.emplace(e.path);
+				links += e.type == utl::EntryType::SYMLINK;
+				bytes += e.type == utl::EntryType::FILE ? e.stat->stx_size : 0;
+				EXPECT_EQ(e.path.substr(e.path.size() - e.name.size()), e.name);
+			});
+
+		EXPECT_EQ(errors, 0);
+		EXPECT_EQ(found, expected);
+		EXPECT_EQ(found.size(), 85 * 8 + 84 + 1);
+		EXPECT_EQ(links, 1);
+		EXPECT_EQ(bytes, 85 * 28);
+	}
+
+	std::filesystem::remove_all(root);
+}
+
+TEST(Walk, Filter)
+{
+	const auto root = temp_tree("utl_walk_filter");
+
+	std::atomic<size_t> files = 0, deepest = 0;
+	utl::walk_directory(
+		root, { .threads = 3, .max_depth = 1 }, [](const utl::DirEntry &e) { return e.name != "dir0"; },
+		[&](const utl::DirEntry &e) {
+			files += e.type == utl::EntryType::FILE;
+			EXPECT_NE(e.name, "dir0");
+			for (size_t d = deepest; d < e.depth && !deepest.compare_exchange_weak(d, e.depth);) {}
+		});
+
+	// Root and 3 of its directories
+	EXPECT_EQ(files, 8 + 3 * 8);
+	EXPECT_EQ(deepest, 1);
+
+	EXPECT_THROW(utl::walk_directory("/nonexistent/utl_walk", {}, [](const utl::DirEntry &) {}), std::system_error);
+	EXPECT_THROW(utl::walk_directory(root, {}, [](const utl::DirEntry &) { throw std::runtime_error("stop"); }),
+				 std::runtime_error);
+
+	std::filesystem::remove_all(root);
+}
+
+TEST(FileReader, Read)
+{
+	std::vector<std::string> paths;
+	std::vector<std::string> contents;
+	for (size_t i = 0; i < 300; ++i)
+	{
+		// Some files larger than the buffers
+		contents.emplace_back(i % 50 == 0 ? std::string(100000 + i, char('a' + i % 26)) : "file " + std::to_string(i));
+		paths.emplace_back(temp_file("utl_read_" + std::to_string(i) + ".txt", contents.back()));
+	}
+	paths.emplace_back("/nonexistent/utl_read");
+
+	for (const bool uring : { true, false })
+	{
+		utl::FileReader reader({ .queue_depth = 8, .buffer_size = 4096, .threads = 3, .io_uring = uring });
+		if (!uring)
+		{
+			EXPECT_FALSE(reader.uses_io_uring());
+		}
+
+		std::mutex			mutex;
+		std::vector<size_t> seen(paths.size(), 0);
+		reader.read(paths, [&](const utl::FileRead &f) {
+			std::scoped_lock l(mutex);
+			++seen[f.index];
+			EXPECT_EQ(f.path, paths[f.index]);
+
+			if (f.index == 300)
+			{
+				EXPECT_EQ(f.error, ENOENT);
+			}
+			else
+			{
+				EXPECT_EQ(f.error, 0);
+				EXPECT_EQ(f.data, contents[f.index]);
+				if (f.index % 50 != 0)
+				{
+					EXPECT_EQ(utl::SequentialParser(f.data).extract(), "file");
+				}
+			}
+		});
+
+		EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), paths.size());
+		EXPECT_THROW(reader.read(paths, [](const utl::FileRead &) { throw std::runtime_error("stop"); }), std::runtime_error);
+	}
+
+	paths.pop_back();
+	for (const auto &p : paths) std::filesystem::remove_all(p);
+}
+
+auto main(int argc, char **argv) -> int
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
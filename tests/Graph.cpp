@@ -1,5 +1,14 @@
 #include <gtest/gtest.h>
 #include <Util/Graph.h>
+#include <Util/EdgeList.h>
+#include <Util/Routes.h>
+#include <Util/SharedGraph.h>
+
+#include <memory_resource>
+#include <random>
+#include <string>
+
+#include <sys/wait.h>
 
 // -----------------------------------------------------------------------------
 // Data
@@ -54,14 +63,323 @@ TEST(Graph, Dijkstra_Search)
 
 TEST(Graph, A_Star)
 {
-	// constexpr size_t comp[]	  = { 0, 0, 1, 2, 3, 2, 5, 0, 2 };
-	// constexpr size_t weight[] = { 0, 4, 12, 19, 28, 16, 18, 8, 14 };
-	// const auto		 res	  = utl::a_star(g2, 0, );
-	// for (size_t i = 0; i < res.first.size(); ++i)
-	// {
-	// 	EXPECT_EQ(comp[i], res.first[i]) << "At index " << i;
-	// 	EXPECT_EQ(weight[i], res.second[i]) << "At index " << i;
-	// }
+	constexpr size_t comp[]	  = { 0, 0, 1, 2, 3, 2, 5, 0, 2 };
+	constexpr size_t weight[] = { 0, 4, 12, 19, 28, 16, 18, 8, 14 };
+
+	// Remaining hops to node 4 as a consistent lower bound
+	constexpr uint32_t hops[] = { 4, 3, 2, 1, 0, 1, 2, 3, 3 };
+	const auto		   res	  = utl::a_star(g2, 0, 4, [&](size_t i) { return hops[i]; });
+
+	EXPECT_EQ(res.second[4], weight[4]);
+	for (size_t i = 4; i != 0; i = res.first[i]) EXPECT_EQ(comp[i], res.first[i]) << "At index " << i;
+
+	const auto all = utl::a_star(
+		g2, 0, [](size_t, uint32_t) { return false; }, [](size_t) { return 0u; });
+	for (size_t i = 0; i < all.first.size(); ++i)
+	{
+		EXPECT_EQ(comp[i], all.first[i]) << "At index " << i;
+		EXPECT_EQ(weight[i], all.second[i]) << "At index " << i;
+	}
+}
+
+/**
+ * @brief Resource counting the allocations passed upstream
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	size_t count = 0;
+
+private:
+	auto do_allocate(size_t bytes, size_t align) -> void * override
+	{
+		++count;
+		return std::pmr::new_delete_resource()->allocate(bytes, align);
+	}
+
+	void do_deallocate(void *p, size_t bytes, size_t align) override
+	{
+		std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+	}
+
+	auto do_is_equal(const std::pmr::memory_resource &o) const noexcept -> bool override { return this == &o; }
+};
+
+TEST(Graph, Memory_Resource)
+{
+	CountingResource	 upstream;
+	utl::ArenaResource arena(&upstream, 256);
+
+	for (size_t query = 0; query < 3; ++query)
+	{
+		const auto before = upstream.count;
+
+		const auto bfs = utl::breadth_first_search(
+			g2, 0, [](size_t) { return false; }, &arena);
+		EXPECT_TRUE(std::equal(bfs.begin(), bfs.end(), utl::breadth_first_search(g2, 0).begin()));
+
+		const auto dij = utl::dijkstra_search(
+			g2, 0, [](size_t, uint32_t) { return false; }, &arena);
+		EXPECT_EQ(dij.second[8], 14);
+		EXPECT_EQ(dij.second.get_allocator().resource(), &arena);
+
+		const auto ast = utl::a_star(
+			g2, 0, 8, [](size_t) { return 0u; }, &arena);
+		EXPECT_EQ(ast.second[8], 14);
+
+		// Only the first query grows the arena, the later ones reuse its memory
+		if (query == 0)
+			EXPECT_GT(upstream.count, 1);
+		else
+			EXPECT_EQ(upstream.count, before);
+
+		arena.reset();
+	}
+}
+
+TEST(Graph, Load_Edge_List)
+{
+	const auto csr = utl::load_edge_list<utl::WeighedEdge>("# comment\n0 7 8\n0 1 4\n1 7 11\n1 2 8\n2 8 2\n2 5 4\n2 3 7\n"
+														   "3 4 9\n3 5 14\n4 5 10\n5 6 2\n6 8 6\n6 7 1\n7 8 7\n\n",
+														   2);
+	const auto g   = csr.graph();
+
+	ASSERT_EQ(g.size, 9);
+	EXPECT_TRUE(std::equal(map2, map2 + 9, g.idx));
+
+	const auto res = utl::dijkstra_search(g, 0);
+	const auto comp = utl::dijkstra_search(g2, 0);
+	EXPECT_EQ(res.second, comp.second);
+}
+
+TEST(Graph, Load_Edge_List_Parallel)
+{
+	std::mt19937					   gen(3);
+	std::vector<std::vector<size_t>> adj(5000);
+	std::string						   text;
+
+	for (size_t i = 0; i < 400000; ++i)
+	{
+		const auto s = gen() % adj.size(), d = gen() % adj.size();
+		adj[s].emplace_back(d);
+		text += std::to_string(s) + (i % 2 ? "\t" : " ") + std::to_string(d) + (i % 3 ? "\n" : " \r\n");
+	}
+
+	const auto csr = utl::load_edge_list(text, 4);
+	ASSERT_EQ(csr.idx.size(), adj.size() + 1);
+
+	for (size_t n = 0; n < adj.size(); ++n)
+	{
+		std::sort(adj[n].begin(), adj[n].end());
+		ASSERT_EQ(csr.idx[n + 1] - csr.idx[n], adj[n].size());
+		for (size_t i = 0; i < adj[n].size(); ++i) ASSERT_EQ(csr.edges[csr.idx[n] + i].dest, adj[n][i]);
+	}
+
+	EXPECT_THROW((void)utl::load_edge_list("1 2\n3 x\n"), std::runtime_error);
+}
+
+TEST(Graph, Shared_Graph)
+{
+	// Random graph, reachable from 0 through a ring
+	std::mt19937					 gen(5);
+	utl::CSRGraph<utl::WeighedEdge> csr;
+	for (size_t n = 0; n < 3000; ++n)
+	{
+		csr.idx.emplace_back(csr.edges.size());
+		csr.edges.push_back({ (n + 1) % 3000, uint32_t(gen() % 100 + 1) });
+		for (size_t i = 0; i < 4; ++i) csr.edges.push_back({ gen() % 3000, uint32_t(gen() % 100 + 1) });
+	}
+	csr.idx.emplace_back(csr.edges.size());
+
+	const auto comp = utl::dijkstra_search(csr.graph(), 0);
+	const auto name = "/utl_test_graph_" + std::to_string(::getpid());
+
+	// Small queues so updates have to wait for later rounds
+	auto shared = utl::SharedGraph<utl::WeighedEdge>::create(name, csr.graph(), { .partitions = 4, .queue_capacity = 16 });
+	ASSERT_EQ(shared.partitions(), 4);
+	EXPECT_EQ(shared.partition(0).begin, 0);
+	EXPECT_EQ(shared.partition(3).end, 3000);
+	EXPECT_EQ(shared.owner(shared.partition(2).begin), 2);
+	EXPECT_THROW((void)utl::SharedGraph<utl::Edge>::attach(name), std::invalid_argument);
+
+	std::vector<pid_t> children;
+	for (size_t p = 0; p < 4; ++p)
+	{
+		const auto pid = ::fork();
+		if (pid == 0)
+		{
+			auto		reader = utl::SharedGraph<utl::WeighedEdge>::attach(name);
+			const auto res	  = utl::partitioned_shortest_paths(reader, p, 0);
+
+			bool ok = reader.graph().size == 3000 && std::equal(csr.idx.begin(), csr.idx.end(), reader.graph().idx);
+			for (size_t i = 0; i < res.dist.size(); ++i) ok = ok && res.dist[i] == comp.second[res.begin + i];
+			::_exit(ok ? 0 : 1);
+		}
+		children.push_back(pid);
+	}
+
+	for (const auto pid : children)
+	{
+		int status = 0;
+		::waitpid(pid, &status, 0);
+		EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	}
+
+	utl::SharedGraph<utl::WeighedEdge>::remove(name);
+	EXPECT_THROW((void)utl::SharedGraph<utl::WeighedEdge>::attach(name), std::system_error);
+}
+
+TEST(Graph, Distance_Table)
+{
+	// Random graph, the last node has no incoming edges
+	std::mt19937					 gen(9);
+	utl::CSRGraph<utl::WeighedEdge> csr;
+	for (size_t n = 0; n < 2001; ++n)
+	{
+		csr.idx.emplace_back(csr.edges.size());
+		for (size_t i = 0; i < 4; ++i) csr.edges.push_back({ gen() % 2000, uint32_t(gen() % 50 + 1) });
+	}
+	csr.idx.emplace_back(csr.edges.size());
+
+	std::vector<size_t> sources, targets = { 2000 };
+	for (size_t i = 0; i < 37; ++i) sources.push_back(gen() % 2001);
+	for (size_t i = 0; i < 50; ++i) targets.push_back(gen() % 2000);
+	sources[5] = sources[6];
+
+	utl::Scheduler s({ .threads = 3 });
+	const auto	   table = utl::distance_table(s, csr.graph(), sources, targets);
+	ASSERT_EQ(table.rows, sources.size());
+	ASSERT_EQ(table.cols, targets.size());
+
+	for (size_t i = 0; i < sources.size(); ++i)
+	{
+		const auto comp = utl::dijkstra_search(csr.graph(), sources[i]);
+		for (size_t j = 0; j < targets.size(); ++j)
+			ASSERT_EQ(table(i, j), comp.second[targets[j]]) << "At " << i << ", " << j;
+	}
+}
+
+/**
+ * @brief Weights of all simple paths, by depth first search
+ */
+template<typename G>
+static void simple_paths(const G &g, size_t u, size_t target, uint32_t w, std::vector<bool> &on, std::vector<uint32_t> &res)
+{
+	if (u == target)
+	{
+		res.push_back(w);
+		return;
+	}
+
+	on[u] = true;
+	for (auto e = g.idx[u]; e < g.idx[u + 1]; ++e)
+		if (!on[g.edges[e].dest])
+			simple_paths(g, g.edges[e].dest, target, w + g.edges[e].weight, on, res);
+	on[u] = false;
+}
+
+/**
+ * @brief Check that a path is connected and loopless
+ */
+template<typename G>
+static auto valid_path(const G &g, const utl::Path &p) -> bool
+{
+	uint32_t w = 0;
+	for (size_t i = 0; i < p.edges.size(); ++i)
+	{
+		const auto e = p.edges[i];
+		if (e < g.idx[p.nodes[i]] || e >= g.idx[p.nodes[i] + 1] || g.edges[e].dest != p.nodes[i + 1])
+			return false;
+		w += g.edges[e].weight;
+	}
+
+	auto nodes = p.nodes;
+	std::sort(nodes.begin(), nodes.end());
+	return w == p.weight && std::adjacent_find(nodes.begin(), nodes.end()) == nodes.end();
+}
+
+TEST(Graph, K_Shortest_Paths)
+{
+	// C D E F G H
+	static constexpr utl::WeighedEdge nodes[] = { { 1, 3 }, { 2, 2 }, { 3, 4 }, { 1, 1 }, { 3, 2 },
+												  { 4, 3 }, { 4, 2 }, { 5, 1 }, { 5, 2 } };
+	static constexpr size_t			  map[]   = { 0, 2, 3, 6, 8, 9, 9 };
+	constexpr utl::Graph<const utl::WeighedEdge *, const size_t *> g{ .edges = nodes, .idx = map, .size = 6 };
+
+	const auto paths = utl::k_shortest_paths(g, 0, 5, 3);
+	ASSERT_EQ(paths.size(), 3);
+	EXPECT_EQ(paths[0].nodes, (std::vector<size_t>{ 0, 2, 3, 5 }));
+	EXPECT_EQ(paths[1].nodes, (std::vector<size_t>{ 0, 2, 4, 5 }));
+	EXPECT_EQ(paths[2].nodes, (std::vector<size_t>{ 0, 1, 3, 5 }));
+	EXPECT_EQ(paths[2].weight, 8);
+
+	// Against all simple paths of random graphs
+	std::mt19937 gen(11);
+	for (size_t round = 0; round < 20; ++round)
+	{
+		utl::CSRGraph<utl::WeighedEdge> csr;
+		for (size_t n = 0; n < 10; ++n)
+		{
+			csr.idx.emplace_back(csr.edges.size());
+			for (size_t i = 0; i < 3; ++i) csr.edges.push_back({ gen() % 10, uint32_t(gen() % 9 + 1) });
+		}
+		csr.idx.emplace_back(csr.edges.size());
+
+		std::vector<uint32_t> comp;
+		std::vector<bool>	  on(10);
+		simple_paths(csr, 0, 9, 0, on, comp);
+		std::sort(comp.begin(), comp.end());
+
+		utl::RouteEngine engine(csr.graph());
+		const auto		 res = engine.k_shortest_paths(0, 9, 12);
+		ASSERT_EQ(res.size(), std::min<size_t>(comp.size(), 12));
+		for (size_t i = 0; i < res.size(); ++i)
+		{
+			EXPECT_EQ(res[i].weight, comp[i]) << "At " << round << ", " << i;
+			EXPECT_TRUE(valid_path(csr, res[i]));
+		}
+	}
+}
+
+TEST(Graph, Alternative_Routes)
+{
+	// Grid of 30 x 30 with random weights in both directions
+	constexpr size_t N = 30;
+
+	std::mt19937					 gen(13);
+	utl::CSRGraph<utl::WeighedEdge> csr;
+	for (size_t n = 0; n < N * N; ++n)
+	{
+		csr.idx.emplace_back(csr.edges.size());
+		const auto x = n % N, y = n / N;
+		if (x > 0)
+			csr.edges.push_back({ n - 1, uint32_t(gen() % 10 + 10) });
+		if (x + 1 < N)
+			csr.edges.push_back({ n + 1, uint32_t(gen() % 10 + 10) });
+		if (y > 0)
+			csr.edges.push_back({ n - N, uint32_t(gen() % 10 + 10) });
+		if (y + 1 < N)
+			csr.edges.push_back({ n + N, uint32_t(gen() % 10 + 10) });
+	}
+	csr.idx.emplace_back(csr.edges.size());
+
+	utl::RouteEngine engine(csr.graph());
+	for (const auto &[s, t] : { std::pair<size_t, size_t>{ 0, N * N - 1 }, { N * N - 1, 0 }, { 31, N * N - 1 } })
+	{
+		const auto routes = engine.alternative_routes(s, t, 3);
+		const auto best	  = utl::dijkstra_search(csr.graph(), s).second[t];
+
+		ASSERT_EQ(routes.size(), 3);
+		EXPECT_EQ(routes[0].weight, best);
+		for (const auto &r : routes)
+		{
+			EXPECT_TRUE(valid_path(csr, r));
+			EXPECT_LE(r.weight, best * 1.5);
+		}
+		EXPECT_NE(routes[1].edges, routes[2].edges);
+	}
+
+	EXPECT_TRUE(engine.alternative_routes(0, N * N - 1, 0).empty());
 }
 
 auto main(int argc, char **argv) -> int
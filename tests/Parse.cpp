@@ -0,0 +1,459 @@
+#include <gtest/gtest.h>
+#include <Util/Grammar.h>
+#include <Util/Parse.h>
+#include <Util/Records.h>
+#include <Util/Stream.h>
+#include <Util/Utf8.h>
+
+#include <array>
+#include <random>
+#include <string>
+#include <thread>
+
+// -----------------------------------------------------------------------------
+// Scan
+// -----------------------------------------------------------------------------
+
+TEST(Scan, Find_First_Of)
+{
+	const utl::CharSet set(",;\n");
+
+	for (size_t len = 0; len < 100; ++len)
+		for (size_t at = 0; at <= len; ++at)
+		{
+			std::string str(len, 'x');
+			if (at != len)
+				str[at] = ';';
+
+			const auto res = utl::find_first_of(str, set);
+			EXPECT_EQ(res, str.find_first_of(",;\n")) << "Length " << len << " at " << at;
+		}
+}
+
+TEST(Scan, Find_First_Not_Of)
+{
+	for (size_t len = 0; len < 100; ++len)
+		for (size_t at = 0; at <= len; ++at)
+		{
+			std::string str(len, ' ');
+			for (size_t i = 0; i < len; i += 3) str[i] = '\t';
+			if (at != len)
+				str[at] = 'x';
+
+			for (size_t pos = 0; pos < 3; ++pos)
+				EXPECT_EQ(utl::find_first_not_of(str, utl::SequentialParser::WHITESPACE_SET, pos),
+						  str.find_first_not_of(utl::SequentialParser::WHITESPACES, pos))
+					<< "Length " << len << " at " << at;
+		}
+}
+
+TEST(Scan, Large_Set)
+{
+	const utl::CharSet set("0123456789abcdefghij");
+	const std::string  str = std::string(70, '.') + "j";
+
+	EXPECT_EQ(set.size(), 20);
+	EXPECT_EQ(utl::find_first_of(str, set), 70);
+	EXPECT_EQ(utl::find_first_not_of("abc0.", set), 4);
+}
+
+TEST(Scan, Constexpr)
+{
+	static_assert(utl::find_first_of("abc def", utl::CharSet(" ")) == 3);
+	static_assert(utl::find_first_not_of("  \tx", utl::SequentialParser::WHITESPACE_SET) == 3);
+	static_assert(utl::find_char("abc", 'c') == 2);
+}
+
+// -----------------------------------------------------------------------------
+// SequentialParser
+// -----------------------------------------------------------------------------
+
+TEST(SequentialParser, Extract)
+{
+	const std::string		str = "  first\tsecond \n  " + std::string(40, 'x') + "  last";
+	utl::SequentialParser p(str);
+
+	p.skip_space();
+	EXPECT_EQ(p.extract(), "first");
+	EXPECT_EQ(p.extract(), "second");
+	EXPECT_EQ(p.extract(), std::string(40, 'x'));
+	EXPECT_EQ(p.extract(), "last");
+	EXPECT_TRUE(p.at_end());
+}
+
+TEST(SequentialParser, Get_Until)
+{
+	utl::SequentialParser p("key=value;other,rest");
+
+	EXPECT_EQ(p.get_until('='), "key");
+	p.skip_for(1);
+	EXPECT_EQ(p.get_until(utl::CharSet(";,")), "value");
+	p.skip_for(1);
+	EXPECT_EQ(p.get_until(utl::CharSet(";,")), "other");
+	EXPECT_EQ(p.get_until('#'), std::nullopt);
+	EXPECT_EQ(p.current(), ',');
+}
+
+TEST(SequentialParser, Get_Integer)
+{
+	utl::SequentialParser p("12345678901234 -42 7x 18446744073709551615 18446744073709551616 -9223372036854775808 "
+							"300 -1");
+
+	EXPECT_EQ(p.get<int64_t>(), 12345678901234);
+	p.skip_space();
+	EXPECT_EQ(p.get<int>(), -42);
+	p.skip_space();
+	EXPECT_EQ(p.get<int>(), 7);
+	EXPECT_EQ(p.get<int>(), std::nullopt);
+	EXPECT_EQ(p.get(), 'x');
+	p.skip_space();
+	EXPECT_EQ(p.get<uint64_t>(), std::numeric_limits<uint64_t>::max());
+	p.skip_space();
+	EXPECT_EQ(p.get<uint64_t>(), std::nullopt);
+	p.skip_for(20);
+	p.skip_space();
+	EXPECT_EQ(p.get<int64_t>(), std::numeric_limits<int64_t>::min());
+	p.skip_space();
+	EXPECT_EQ(p.get<uint8_t>(), std::nullopt);
+	EXPECT_EQ(p.get<uint16_t>(), 300);
+	p.skip_space();
+	EXPECT_EQ(p.get<unsigned>(), std::nullopt);
+	EXPECT_EQ(p.get<int>(), -1);
+	EXPECT_TRUE(p.at_end());
+
+	static_assert(utl::SequentialParser("123456789").get<int>() == 123456789);
+}
+
+TEST(SequentialParser, Get_Integer_Digits)
+{
+	for (uint64_t v = 1, i = 0; i < 19; ++i, v = v * 10 + i % 10)
+	{
+		const auto str = std::to_string(v) + ",";
+		EXPECT_EQ(utl::SequentialParser(str).get<uint64_t>(), v) << str;
+	}
+}
+
+TEST(SequentialParser, Get_Float)
+{
+	utl::SequentialParser p("3.25 -1e-3 abc");
+
+	EXPECT_EQ(p.get<double>(), 3.25);
+	p.skip_space();
+	EXPECT_FLOAT_EQ(*p.get<float>(), -1e-3f);
+	p.skip_space();
+	EXPECT_EQ(p.get<double>(), std::nullopt);
+	EXPECT_EQ(p.current(), 'a');
+}
+
+TEST(SequentialParser, Get_Hex)
+{
+	utl::SequentialParser p("0xFF 1a2B 0xg");
+
+	EXPECT_EQ(p.get_hex<int>(), 255);
+	p.skip_space();
+	EXPECT_EQ(p.get_hex<uint32_t>(), 0x1A2B);
+	p.skip_space();
+	EXPECT_EQ(p.get_hex<uint8_t>(), 0);
+	EXPECT_EQ(p.current(), 'x');
+}
+
+// -----------------------------------------------------------------------------
+// KeywordMatcher
+// -----------------------------------------------------------------------------
+
+static constexpr std::array<std::string_view, 6> keywords = { "GET", "GETALL", "POST", "PUT", "P", "GET" };
+
+TEST(KeywordMatcher, Longest)
+{
+	constexpr utl::KeywordMatcher<keywords> m;
+
+	static_assert(m.match("GETALLx") == 1);
+	static_assert(m.match("GETAx") == 0);
+	static_assert(m.match("PUx") == 4);
+	static_assert(m.match("x") == std::nullopt);
+
+	utl::SequentialParser p("POSTGETPUTx");
+	EXPECT_EQ(p.get_one_of(m), keywords.begin() + 2);
+	EXPECT_EQ(p.get_one_of(m), keywords.begin());
+	EXPECT_EQ(p.get_one_of(m), keywords.begin() + 3);
+	EXPECT_EQ(p.get_one_of(m), keywords.end());
+	EXPECT_EQ(p.rest(), "x");
+}
+
+static constexpr std::string_view many_keywords[] = {
+	"alpha", "alp", "beta", "bet", "gamma", "delta", "del", "d", "epsilon", "eps", "zeta", "eta", "theta", "iota",
+	"kappa", "lambda", "lamb", "mu",  "nu",	   "xi",   "omicron", "pi", "rho", "sigma", "tau", "upsilon", "phi"
+};
+
+TEST(KeywordMatcher, Brute_Force)
+{
+	constexpr utl::KeywordMatcher<many_keywords> m;
+	std::mt19937								 gen(42);
+
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		std::string str;
+		for (size_t n = gen() % 8; n != 0; --n) str += "adeghilmnoprstuxz"[gen() % 17];
+
+		std::optional<size_t> best;
+		for (size_t k = 0; k < std::size(many_keywords); ++k)
+			if (str.starts_with(many_keywords[k]) && (!best || many_keywords[k].size() > many_keywords[*best].size()))
+				best = k;
+
+		EXPECT_EQ(m.match(str), best) << str;
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Grammar
+// -----------------------------------------------------------------------------
+
+TEST(Grammar, Sequence)
+{
+	using namespace utl::grammar;
+
+	constexpr auto request = one_of<keywords> >> ws >> until(' ') >> ws >> number<int> >> ws >> number<double>;
+	static_assert(std::is_same_v<decltype(request)::value_type, std::tuple<size_t, std::string_view, int, double>>);
+
+	utl::SequentialParser p("POST /index.html 200 0.25\nrest");
+	EXPECT_EQ(parse(request, p), std::tuple(size_t(2), std::string_view("/index.html"), 200, 0.25));
+	EXPECT_EQ(p.rest(), "\nrest");
+
+	utl::SequentialParser q("GET /x abc 1.0");
+	EXPECT_EQ(parse(request, q), std::nullopt);
+	EXPECT_EQ(q.current_loc(), 0);
+}
+
+TEST(Grammar, Alternative_Repeat)
+{
+	using namespace utl::grammar;
+
+	constexpr auto list	 = lit("[") >> repeat(number<int>, lit(",") >> ws) >> lit("]");
+	constexpr auto value = number<int> | word;
+	constexpr auto flags = repeat(lit("-v")) >> opt(lit("=") >> number<unsigned>);
+
+	utl::SequentialParser p("[1, -2,3]");
+	EXPECT_EQ(parse(list, p), std::tuple(std::vector { 1, -2, 3 }));
+	EXPECT_TRUE(p.at_end());
+
+	utl::SequentialParser q("[]");
+	EXPECT_EQ(parse(list, q), std::tuple(std::vector<int>()));
+
+	utl::SequentialParser r("[1,]");
+	EXPECT_EQ(parse(list, r), std::nullopt);
+
+	utl::SequentialParser s("12 word");
+	EXPECT_EQ(std::get<0>(*parse(value, s)), 12);
+	s.skip_space();
+	EXPECT_EQ(std::get<1>(*parse(value, s)), "word");
+
+	utl::SequentialParser t("-v-v-v=4");
+	EXPECT_EQ(parse(flags, t), std::tuple(size_t(3), std::optional(std::tuple(4U))));
+}
+
+TEST(Grammar, Repeat_Zero_Width)
+{
+	using namespace utl::grammar;
+
+	// Elements matching without consuming input are taken once
+	utl::SequentialParser p("ab;cd");
+	EXPECT_EQ(parse(repeat(until(";")), p), (std::vector<std::string_view> { "ab", "" }));
+	EXPECT_EQ(p.rest(), ";cd");
+
+	utl::SequentialParser q("xxy");
+	EXPECT_EQ(parse(repeat(opt(lit("x"))), q), (std::vector<bool> { true, true, false }));
+	EXPECT_EQ(q.rest(), "y");
+
+	utl::SequentialParser r("y");
+	EXPECT_EQ(parse(repeat(ws), r), size_t(1));
+	EXPECT_EQ(r.rest(), "y");
+}
+
+// -----------------------------------------------------------------------------
+// RecordParser
+// -----------------------------------------------------------------------------
+
+static auto flatten(const std::vector<utl::RecordChunk> &chunks) -> std::vector<std::vector<std::string_view>>
+{
+	std::vector<std::vector<std::string_view>> res;
+	for (const auto &c : chunks)
+		for (size_t i = 0; i < c.size(); ++i) res.emplace_back(c[i].begin(), c[i].end());
+	return res;
+}
+
+TEST(RecordParser, Quotes)
+{
+	const std::string_view str = "a,b,c\r\n\"x,\ny\",\"\"\"q\"\"\",\n,,\nlast,\"\"";
+	const auto			   res = flatten(utl::RecordParser().parse(str));
+
+	using row = std::vector<std::string_view>;
+	ASSERT_EQ(res.size(), 4);
+	EXPECT_EQ(res[0], (row{ "a", "b", "c" }));
+	EXPECT_EQ(res[1], (row{ "x,\ny", "\"\"q\"\"", "" }));
+	EXPECT_EQ(res[2], (row{ "", "", "" }));
+	EXPECT_EQ(res[3], (row{ "last", "" }));
+}
+
+TEST(RecordParser, Parallel)
+{
+	std::mt19937 gen(7);
+	std::string	 str;
+	std::vector<std::vector<std::string>> comp;
+
+	while (str.size() < (1U << 20))
+	{
+		auto &row = comp.emplace_back();
+		for (size_t n = gen() % 6 + 1; n != 0; --n)
+		{
+			auto &field = row.emplace_back(std::to_string(gen()));
+			if (gen() % 4 == 0)
+				field += "\t\n";
+			str += (gen() % 3 == 0 || field.back() == '\n') ? '"' + field + '"' : field;
+			str += n == 1 ? '\n' : '\t';
+		}
+	}
+
+	const auto res = flatten(utl::RecordParser({ .delim = '\t' }, 4).parse(str));
+
+	ASSERT_EQ(res.size(), comp.size());
+	for (size_t i = 0; i < res.size(); ++i)
+		ASSERT_TRUE(std::equal(res[i].begin(), res[i].end(), comp[i].begin(), comp[i].end())) << "Record " << i;
+}
+
+// -----------------------------------------------------------------------------
+// UTF-8
+// -----------------------------------------------------------------------------
+
+static auto reference_utf8(std::string_view str) -> bool
+{
+	for (size_t i = 0, n; i < str.size(); i += n)
+		if ((n = utl::detail::_utf8_length_(str.data() + i, str.data() + str.size())) == 0)
+			return false;
+	return true;
+}
+
+TEST(Utf8, Validate)
+{
+	EXPECT_TRUE(utl::validate_utf8(""));
+	EXPECT_TRUE(utl::validate_utf8("ascii \xC3\xA4 \xE2\x82\xAC \xF0\x9F\x98\x80"));
+	EXPECT_FALSE(utl::validate_utf8("\xC0\xAF"));		// Overlong
+	EXPECT_FALSE(utl::validate_utf8("\xED\xA0\x80"));	// Surrogate
+	EXPECT_FALSE(utl::validate_utf8("\xF4\x90\x80\x80")); // Too large
+	EXPECT_FALSE(utl::validate_utf8("\x80"));			// Lone continuation
+	EXPECT_FALSE(utl::validate_utf8(std::string(31, 'a') + "\xE2\x82")); // Cut off at block end
+	EXPECT_FALSE(utl::validate_utf8(std::string(30, 'a') + "\xE2\x82"));
+	EXPECT_TRUE(utl::validate_utf8(std::string(31, 'a') + "\xE2\x82\xAC"));
+}
+
+TEST(Utf8, Validate_Random)
+{
+	constexpr std::string_view pieces[] = { "a", "\xC3\xA4", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xEF\xBF\xBD", " " };
+	std::mt19937			   gen(11);
+
+	for (size_t i = 0; i < 3000; ++i)
+	{
+		std::string str;
+		for (size_t n = gen() % 80; n != 0; --n) str += pieces[gen() % std::size(pieces)];
+
+		if (!str.empty() && i % 2)
+			str[gen() % str.size()] = static_cast<char>(gen());
+
+		EXPECT_EQ(utl::validate_utf8(str), reference_utf8(str)) << i;
+	}
+}
+
+TEST(Utf8, Parser)
+{
+	const auto		str = "gr\xC3\xBC\xC3\x9F \xE2\x82\xAC" + std::string(40, 'x') + "\xE2\x86\x92" "end";
+	utl::Utf8Parser p(str);
+
+	EXPECT_EQ(p.take(3), "gr\xC3\xBC");
+	EXPECT_EQ(p.peek(), U'\u00DF');
+	EXPECT_EQ(p.get(), U'\u00DF');
+	EXPECT_EQ(p.take(), "");
+	p.skip_space();
+	EXPECT_EQ(p.get(), U'\u20AC');
+	EXPECT_EQ(p.get_until(U'\u2192'), std::string(40, 'x'));
+	EXPECT_EQ(p.get(), U'\u2192');
+	EXPECT_EQ(p.take(), "end");
+	EXPECT_TRUE(p.at_end());
+	EXPECT_TRUE(p.valid());
+
+	utl::Utf8Parser bad(std::string(40, 'a') + " \xFF");
+	EXPECT_EQ(bad.take(), std::nullopt);
+	EXPECT_FALSE(bad.valid());
+}
+
+// -----------------------------------------------------------------------------
+// StreamParser
+// -----------------------------------------------------------------------------
+
+static auto write_pipe(std::string_view str, size_t step) -> std::pair<int, std::thread>
+{
+	int fds[2];
+	EXPECT_EQ(pipe(fds), 0);
+
+	return { fds[0], std::thread([fd = fds[1], str, step] {
+				 for (size_t i = 0; i < str.size(); i += step) // Small writes to split tokens between reads
+					 EXPECT_GT(write(fd, str.data() + i, std::min(step, str.size() - i)), 0);
+				 close(fd);
+			 }) };
+}
+
+TEST(StreamParser, Extract)
+{
+	auto [fd, writer] = write_pipe("  alpha beta\tgamma \n  key=value;x,y    end", 3);
+	utl::StreamParser p(fd, 8);
+
+	p.skip_space();
+	EXPECT_EQ(p.extract(), "alpha");
+	EXPECT_EQ(p.extract(), "beta");
+	EXPECT_EQ(p.extract(), "gamma");
+	EXPECT_EQ(p.get_until('='), "key");
+	EXPECT_EQ(p.get(), '=');
+	EXPECT_EQ(p.get_until(utl::CharSet(";,")), "value");
+	p.skip_till(',');
+	EXPECT_EQ(p.take(), "y");
+	EXPECT_EQ(p.get_until('#'), std::nullopt);
+	EXPECT_EQ(p.next(), 'e');
+	EXPECT_EQ(p.extract(), "nd");
+	EXPECT_TRUE(p.at_end());
+	EXPECT_EQ(p.current_loc(), 42);
+
+	writer.join();
+	close(fd);
+}
+
+TEST(StreamParser, Long_Input)
+{
+	std::string str;
+	for (size_t i = 0; i < 10000; ++i) str += std::to_string(i) + (i % 7 ? " " : "\n\t");
+
+	auto [fd, writer] = write_pipe(str, 4096);
+	utl::StreamParser p(fd, 16);
+
+	for (size_t i = 0; i < 10000; ++i) ASSERT_EQ(p.extract(), std::to_string(i));
+	EXPECT_TRUE(p.at_end());
+
+	writer.join();
+	close(fd);
+}
+
+TEST(StreamParser, Token_Too_Long)
+{
+	const auto str	  = "short " + std::string(64, 'x');
+	auto [fd, writer] = write_pipe(str, 64);
+	utl::StreamParser p(fd, 16);
+
+	EXPECT_EQ(p.extract(), "short");
+	EXPECT_THROW(p.take(), std::length_error);
+
+	writer.join();
+	close(fd);
+}
+
+auto main(int argc, char **argv) -> int
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
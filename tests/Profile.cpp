@@ -0,0 +1,141 @@
+#define UTL_PROFILE
+#include <gtest/gtest.h>
+#include <Util/Profile.h>
+
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class StringPolicy
+{
+public:
+	explicit StringPolicy(std::shared_ptr<std::string> out)
+		: m_out(std::move(out))
+	{
+	}
+
+	void open() noexcept {}
+	void close() noexcept {}
+
+	template<typename T>
+	void write(const T &msg, utl::Catagory)
+	{
+		utl::detail::_append_(*m_out, msg);
+	}
+
+private:
+	std::shared_ptr<std::string> m_out;
+};
+
+static void sleep_scope(std::chrono::microseconds t)
+{
+	UTL_PROFILE_SCOPE("sleep");
+	const auto end = std::chrono::steady_clock::now() + t;
+	while (std::chrono::steady_clock::now() < end) {}
+}
+
+TEST(Profile, Histogram)
+{
+	using H = utl::detail::_ProfileHistogram_;
+
+	for (uint64_t v : { 0ULL, 1ULL, 63ULL, 64ULL, 65ULL, 1000ULL, 123456789ULL, ~0ULL })
+	{
+		const auto b = H::bucket(v);
+		EXPECT_LE(v, H::bucket_max(b));
+		if (b > 0)
+		{
+			EXPECT_GT(v, H::bucket_max(b - 1));
+		}
+		EXPECT_LE(H::bucket_max(b) - v, v / 32);
+	}
+}
+
+/**
+ * @brief Totals of known tick values
+ */
+static auto totals(std::initializer_list<std::pair<uint64_t, uint64_t>> samples) -> utl::detail::_ProfileTotals_
+{
+	using H = utl::detail::_ProfileHistogram_;
+
+	utl::detail::_ProfileTotals_ t;
+	t.label = "known";
+	for (const auto &[ticks, n] : samples)
+	{
+		t.counts[H::bucket(ticks)] += n;
+		t.sum += ticks * n;
+		t.max = std::max(t.max, ticks);
+	}
+	return t;
+}
+
+TEST(Profile, Percentiles)
+{
+	const auto s = utl::detail::_profile_stats_(totals({ { 10, 990 }, { 50, 9 }, { 5000, 1 } }), 1.0);
+
+	EXPECT_EQ(s.label, "known");
+	EXPECT_EQ(s.count, 1000);
+	EXPECT_EQ(s.mean, 15);
+	EXPECT_EQ(s.p50, 10);
+	EXPECT_EQ(s.p90, 10);
+	EXPECT_EQ(s.p99, 10);
+	EXPECT_EQ(s.p999, 50);
+	EXPECT_EQ(s.max, 5000);
+
+	// Ticks are converted to nanoseconds
+	EXPECT_EQ(utl::detail::_profile_stats_(totals({ { 10, 990 }, { 50, 9 }, { 5000, 1 } }), 2.0).p999, 100);
+	EXPECT_EQ(utl::detail::_profile_stats_(totals({}), 1.0).count, 0);
+}
+
+TEST(Profile, Interval)
+{
+	const auto first = totals({ { 10, 99 }, { 5000, 1 } });
+	const auto now	 = totals({ { 10, 199 }, { 20, 100 }, { 5000, 1 } });
+
+	// The outlier of the previous interval is not reported again
+	const auto s = utl::detail::_profile_stats_(utl::detail::_profile_delta_(now, first), 1.0);
+	EXPECT_EQ(s.count, 200);
+	EXPECT_EQ(s.p99, 20);
+	EXPECT_EQ(s.max, 20);
+}
+
+TEST(Profile, Collect)
+{
+	utl::Profiler p;
+	(void)p.collect();
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 4; ++t)
+		threads.emplace_back([] {
+			for (size_t i = 0; i < 100; ++i) sleep_scope(std::chrono::microseconds(10));
+		});
+	for (auto &t : threads) t.join();
+
+	const auto stats = p.collect();
+	ASSERT_EQ(stats.size(), 1);
+	EXPECT_EQ(stats[0].label, "sleep");
+	EXPECT_EQ(stats[0].count, 400);
+
+	// Only new samples are reported
+	sleep_scope(std::chrono::microseconds(10));
+	const auto next = p.collect();
+	ASSERT_EQ(next.size(), 1);
+	EXPECT_EQ(next[0].count, 1);
+	EXPECT_TRUE(p.collect().empty());
+
+	auto			  out = std::make_shared<std::string>();
+	utl::Logger<StringPolicy> log(StringPolicy { out });
+	utl::dump_profile(log, stats);
+	EXPECT_NE(out->find("profile sleep: n=400 "), std::string::npos);
+	EXPECT_NE(out->find(" p99="), std::string::npos);
+}
+
+auto main(int argc, char **argv) -> int
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <Util/Scheduler.h>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+static auto fib(utl::Scheduler &s, unsigned n) -> uint64_t
+{
+	if (n < 2)
+		return n;
+
+	uint64_t	   a = 0;
+	utl::TaskGroup g(s);
+	g.run([&] { a = fib(s, n - 1); });
+	const auto b = fib(s, n - 2);
+	g.wait();
+
+	return a + b;
+}
+
+TEST(Scheduler, Parallel_For)
+{
+	utl::Scheduler s({ .threads = 4 });
+
+	std::vector<std::atomic<uint8_t>> seen(1'000'003);
+	utl::parallel_for(s, 0, seen.size(), [&](size_t i) { seen[i].fetch_add(1, std::memory_order_relaxed); });
+	EXPECT_TRUE(std::all_of(seen.begin(), seen.end(), [](const auto &v) { return v == 1; }));
+
+	std::atomic<uint64_t> sum = 0;
+	utl::parallel_for(
+		s, 10, 100'010,
+		[&](size_t b, size_t e) {
+			uint64_t part = 0;
+			for (; b < e; ++b) part += b;
+			sum += part;
+		},
+		64);
+	EXPECT_EQ(sum, (10 + 100'009) * uint64_t(100'000) / 2);
+
+	// Shared scheduler, nested loops
+	std::atomic<size_t> count = 0;
+	utl::parallel_for(0, 100, [&](size_t) { utl::parallel_for(0, 100, [&](size_t) { ++count; }); });
+	EXPECT_EQ(count, 100 * 100);
+}
+
+TEST(Scheduler, Task_Group)
+{
+	utl::Scheduler s({ .threads = 3, .pin = true });
+	EXPECT_EQ(fib(s, 22), 17711);
+	EXPECT_FALSE(s.is_worker());
+
+	utl::TaskGroup		g(s);
+	std::atomic<size_t> done = 0;
+	for (size_t i = 0; i < 100; ++i)
+		g.run([&, i] {
+			if (i == 50)
+				throw std::runtime_error("task");
+			++done;
+		});
+	EXPECT_THROW(g.wait(), std::runtime_error);
+	EXPECT_LE(done, 99);
+
+	EXPECT_THROW(utl::parallel_for(s, 0, 1000, [](size_t i) {
+		if (i == 999)
+			throw std::out_of_range("loop");
+	}),
+				 std::out_of_range);
+}
+
+auto main(int argc, char **argv) -> int
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
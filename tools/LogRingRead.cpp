@@ -0,0 +1,35 @@
+#include <Util/FileSystem.h>
+#include <Util/RingLog.h>
+
+#include <cstdio>
+#include <exception>
+#include <iostream>
+
+/**
+ * @brief Print the log of utl::MappedRingPolicy ring files in chronological order
+ * Usage: LogRingRead <file>...
+ */
+auto main(int argc, char **argv) -> int
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " <file>...\n";
+		return 1;
+	}
+
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const utl::MappedFile file(argv[i]);
+			utl::read_log_ring(file.view(), [](std::string_view line) { std::fwrite(line.data(), 1, line.size(), stdout); });
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << '\n';
+		return 1;
+	}
+
+	return 0;
+}